@@ -35,7 +35,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <sys/types.h>
 #include <errno.h>
 #include <fcntl.h>
-#include <regex.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
+#include <ifaddrs.h>
 
 #include "ds_dlist.h"
 #include "ds_tree.h"
@@ -44,7 +48,6 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "util.h"
 #include "daemon.h"
 #include "os_file.h"
-#include "os_regex.h"
 
 #include "osn_dhcp.h"
 #include "kconfig.h"
@@ -61,9 +64,12 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /* Debounce timer, the maximum amount time to wait before initializing DHCP leases */
 #define DHCP_LEASE_INIT_DEBOUNCE_TIMER     0.3
 
-/* Number of elements to add to the lease array each time it is resized */
+/* Initial size of the lease pool; it doubles when full and halves when mostly unused */
 #define DHCP_LEASE_RESIZE_QUANTUM          16
 
+/* Copy of a lease line kept for the error log, longer lines are truncated */
+#define DHCP_LEASE_LINE_LOG_MAX            256
+
 struct osn_dhcp_server
 {
     char                            ds_ifname[C_IFNAME_LEN];
@@ -74,6 +80,38 @@ struct osn_dhcp_server
 
     /* IP pool range list */
     ds_tree_t                       ds_range_list;
+
+    /* Interface subnet in host byte order, routes leases outside every range */
+    uint32_t                        ds_subnet;
+    uint32_t                        ds_netmask;
+
+    /* Static reservations, keyed by MAC and by IP address */
+    ds_tree_t                       ds_resv_mac;
+    ds_tree_t                       ds_resv_ip;
+
+    /* Option values indexed by option code, NULL when not set */
+    char                           *ds_options[DHCP_OPTION_MAX];
+
+    /* Rendered dnsmasq files are rewritten only if these are set and their hash changed */
+    bool                            ds_resv_dirty;
+    bool                            ds_opts_dirty;
+    uint64_t                        ds_resv_hash;
+    uint64_t                        ds_opts_hash;
+
+    /*
+     * Leases are kept in ds_status.ds_leases, a pool of ds_leases_cap entries.
+     * ds_lease_index is an open addressing hash table of pool indices keyed
+     * by (MAC, IP), twice the pool size; -1 marks an empty slot.
+     */
+    int                             ds_leases_cap;
+    int32_t                        *ds_lease_index;
+
+    /* Leases before the current lease file change, used to detect changes */
+    struct osn_dhcp_server_lease   *ds_leases_prev;
+    int                             ds_leases_prev_len;
+
+    /* The first status is always sent, later ones only if the leases changed */
+    bool                            ds_status_sent;
 };
 
 /*
@@ -86,6 +124,29 @@ struct dhcp_range
     ds_tree_node_t                  dr_tnode;
 };
 
+/*
+ * Entry of the sorted index of all servers' IP ranges, in host byte order
+ */
+struct dhcp_range_idx
+{
+    uint32_t                        ri_start;
+    uint32_t                        ri_stop;
+    uint32_t                        ri_stop_max;    /* highest ri_stop up to this entry */
+    osn_dhcp_server_t              *ri_server;
+};
+
+/*
+ * Static reservation
+ */
+struct dhcp_reservation
+{
+    osn_mac_addr_t                  rs_macaddr;
+    osn_ip_addr_t                   rs_ipaddr;
+    char                            rs_hostname[C_HOSTNAME_LEN];
+    ds_tree_node_t                  rs_tnode_mac;
+    ds_tree_node_t                  rs_tnode_ip;
+};
+
 /* IP range comparison function */
 int dhcp_range_cmp(const void *_a, const void *_b)
 {
@@ -104,12 +165,18 @@ int dhcp_range_cmp(const void *_a, const void *_b)
  * Static functions
  */
 static bool               dhcp_server_init(osn_dhcp_server_t *self, const char *ifname);
-static bool               lease_exists(struct osn_dhcp_server_status *st, struct osn_dhcp_server_lease *dl);
-static bool               dhcp_server_lease_parse_line(struct osn_dhcp_server_lease *dl, const char *line);
+static int                dhcp_lease_find(osn_dhcp_server_t *self, const struct osn_dhcp_server_lease *dl);
+static bool               dhcp_server_lease_parse_line(struct osn_dhcp_server_lease *dl, char *line);
 static osn_dhcp_server_t* dhcp_server_find_by_lease(struct osn_dhcp_server_lease *dl);
 static void               dhcp_server_lease_add(osn_dhcp_server_t *self, struct osn_dhcp_server_lease *dl);
 static void               dhcp_lease_onchange(struct ev_loop *loop, ev_stat *w, int revent);
 static void               dhcp_lease_init(struct ev_loop *loop, struct ev_debounce *ev, int revent);
+static void               dhcp_lease_clear(osn_dhcp_server_t *self);
+static void               dhcp_lease_update(bool parse);
+static void               dhcp_range_index_invalidate(void);
+static void               dhcp_reservation_remove(osn_dhcp_server_t *self, struct dhcp_reservation *rs);
+static bool               dhcp_conf_render(osn_dhcp_server_t *self);
+static void               dhcp_conf_remove(osn_dhcp_server_t *self);
 
 /*
  * Globals
@@ -118,6 +185,17 @@ static ds_dlist_t   dhcp_server_list = DS_DLIST_INIT(osn_dhcp_server_t, ds_dnode
 static ev_debounce  dhcp_lease_init_debounce;
 static ev_stat      dhcp_lease_watcher;
 
+/* Files shared with dnsmasq, dhcp_test points them to a scratch directory */
+static const char  *dhcp_leases_path = CONFIG_RDK_DHCP_LEASES_PATH;
+static const char  *dhcp_hosts_dir = CONFIG_RDK_DHCP_HOSTS_DIR;
+static const char  *dhcp_opts_dir = CONFIG_RDK_DHCP_OPTS_DIR;
+static const char  *dhcp_pid_path = CONFIG_RDK_DHCP_PID_PATH;
+
+/* Index of IP ranges used to route leases to servers, rebuilt on first use after a change */
+static struct dhcp_range_idx   *dhcp_range_index;
+static int                      dhcp_range_index_len;
+static bool                     dhcp_range_index_valid;
+
 /*
  * ===========================================================================
  *  OSync DHCPv4 Server API
@@ -140,6 +218,8 @@ bool osn_dhcp_server_del(osn_dhcp_server_t *self)
 {
     ds_tree_iter_t iter;
     struct dhcp_range *dr;
+    struct dhcp_reservation *rs;
+    int opt;
 
     /* Free DHCP range list */
     ds_tree_foreach_iter(&self->ds_range_list, dr, &iter)
@@ -148,14 +228,34 @@ bool osn_dhcp_server_del(osn_dhcp_server_t *self)
         FREE(dr);
     }
 
+    /* Free reservations and options */
+    while ((rs = ds_tree_head(&self->ds_resv_mac)) != NULL)
+    {
+        dhcp_reservation_remove(self, rs);
+    }
+
+    for (opt = 0; opt < DHCP_OPTION_MAX; opt++)
+    {
+        if (self->ds_options[opt] != NULL) FREE(self->ds_options[opt]);
+    }
+
+    dhcp_conf_remove(self);
+
     /* Remove the DHCP server object instance from the global list */
     ds_dlist_remove(&dhcp_server_list, self);
+    dhcp_range_index_invalidate();
+
+    dhcp_lease_clear(self);
 
     /* Stop the lease watcher and DHCP lease initialization */
     if (ev_is_active(&dhcp_lease_watcher) && ds_dlist_is_empty(&dhcp_server_list))
     {
         ev_stat_stop(EV_DEFAULT, &dhcp_lease_watcher);
         ev_debounce_stop(EV_DEFAULT, &dhcp_lease_init_debounce);
+
+        if (dhcp_range_index != NULL) FREE(dhcp_range_index);
+        dhcp_range_index = NULL;
+        dhcp_range_index_len = 0;
     }
 
     FREE(self);
@@ -184,7 +284,7 @@ void* osn_dhcp_server_data_get(osn_dhcp_server_t *self)
 
 bool osn_dhcp_server_apply(osn_dhcp_server_t *self)
 {
-    return true;
+    return dhcp_conf_render(self);
 }
 
 bool osn_dhcp_server_range_add(osn_dhcp_server_t *self, osn_ip_addr_t start, osn_ip_addr_t stop)
@@ -205,6 +305,8 @@ bool osn_dhcp_server_range_add(osn_dhcp_server_t *self, osn_ip_addr_t start, osn
     dr->dr_range_stop = stop;
     ds_tree_insert(&self->ds_range_list, dr, dr);
 
+    dhcp_range_index_invalidate();
+
     return true;
 }
 
@@ -221,6 +323,8 @@ bool osn_dhcp_server_range_del(osn_dhcp_server_t *self, osn_ip_addr_t start, osn
 
     FREE(dr);
 
+    dhcp_range_index_invalidate();
+
     return true;
 }
 
@@ -231,11 +335,57 @@ bool osn_dhcp_server_reservation_add(
         const char *hostname)
 
 {
+    struct dhcp_reservation *rs;
+
+    if (hostname == NULL) hostname = "";
+
+    rs = ds_tree_find(&self->ds_resv_mac, &macaddr);
+    if (rs != NULL)
+    {
+        if (osn_ip_addr_cmp(&rs->rs_ipaddr, &ipaddr) == 0 && strcmp(rs->rs_hostname, hostname) == 0)
+        {
+            return true;
+        }
+
+        dhcp_reservation_remove(self, rs);
+    }
+
+    /* The address can be reserved for a single client only */
+    rs = ds_tree_find(&self->ds_resv_ip, &ipaddr);
+    if (rs != NULL)
+    {
+        LOG(WARNING, "dhcpv4_server: %s: Reservation of "PRI_osn_ip_addr" moved from "PRI_osn_mac_addr" to "PRI_osn_mac_addr".",
+                self->ds_ifname,
+                FMT_osn_ip_addr(ipaddr),
+                FMT_osn_mac_addr(rs->rs_macaddr),
+                FMT_osn_mac_addr(macaddr));
+        dhcp_reservation_remove(self, rs);
+    }
+
+    rs = CALLOC(1, sizeof(struct dhcp_reservation));
+    rs->rs_macaddr = macaddr;
+    rs->rs_ipaddr = ipaddr;
+    if (strscpy(rs->rs_hostname, hostname, sizeof(rs->rs_hostname)) < 0)
+    {
+        LOG(WARNING, "dhcpv4_server: %s: Reservation hostname truncated: %s", self->ds_ifname, hostname);
+    }
+
+    ds_tree_insert(&self->ds_resv_mac, rs, &rs->rs_macaddr);
+    ds_tree_insert(&self->ds_resv_ip, rs, &rs->rs_ipaddr);
+    self->ds_resv_dirty = true;
+
     return true;
 }
 
 bool osn_dhcp_server_reservation_del(osn_dhcp_server_t *self, osn_mac_addr_t macaddr)
 {
+    struct dhcp_reservation *rs;
+
+    rs = ds_tree_find(&self->ds_resv_mac, &macaddr);
+    if (rs == NULL) return true;
+
+    dhcp_reservation_remove(self, rs);
+
     return true;
 }
 
@@ -254,6 +404,33 @@ bool osn_dhcp_server_option_set(
         enum osn_dhcp_option opt,
         const char *value)
 {
+    char **popt;
+
+    if ((int)opt <= 0 || opt >= DHCP_OPTION_MAX)
+    {
+        LOG(ERR, "dhcpv4_server: %s: Invalid DHCP option %d.", self->ds_ifname, opt);
+        return false;
+    }
+
+    popt = &self->ds_options[opt];
+
+    if (value == NULL)
+    {
+        if (*popt == NULL) return true;
+
+        FREE(*popt);
+        *popt = NULL;
+    }
+    else
+    {
+        if (*popt != NULL && strcmp(*popt, value) == 0) return true;
+
+        if (*popt != NULL) FREE(*popt);
+        *popt = STRDUP(value);
+    }
+
+    self->ds_opts_dirty = true;
+
     return true;
 }
 
@@ -279,13 +456,17 @@ static bool dhcp_server_init(osn_dhcp_server_t *self, const char *ifname)
     /* Initialize IP range list */
     ds_tree_init(&self->ds_range_list, dhcp_range_cmp, struct dhcp_range, dr_tnode);
 
+    /* Initialize reservations */
+    ds_tree_init(&self->ds_resv_mac, osn_mac_addr_cmp, struct dhcp_reservation, rs_tnode_mac);
+    ds_tree_init(&self->ds_resv_ip, osn_ip_addr_cmp, struct dhcp_reservation, rs_tnode_ip);
+
     if (ds_dlist_is_empty(&dhcp_server_list))
     {
         /* Initialize the DHCP leases file watcher */
         ev_stat_init(
             &dhcp_lease_watcher,
             dhcp_lease_onchange,
-            CONFIG_RDK_DHCP_LEASES_PATH,
+            dhcp_leases_path,
             0.0);
 
         ev_stat_start(EV_DEFAULT, &dhcp_lease_watcher);
@@ -301,6 +482,217 @@ static bool dhcp_server_init(osn_dhcp_server_t *self, const char *ifname)
     return true;
 }
 
+static void dhcp_reservation_remove(osn_dhcp_server_t *self, struct dhcp_reservation *rs)
+{
+    ds_tree_remove(&self->ds_resv_mac, rs);
+    ds_tree_remove(&self->ds_resv_ip, rs);
+    FREE(rs);
+
+    self->ds_resv_dirty = true;
+}
+
+static uint64_t dhcp_conf_hash(const char *buf, size_t len)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    size_t i;
+
+    for (i = 0; i < len; i++) hash = (hash ^ (uint8_t)buf[i]) * 1099511628211ULL;
+
+    return hash;
+}
+
+/*
+ * Replace the file dir/ifname with the content of buf, atomically
+ */
+static bool dhcp_conf_write(const char *dir, const char *ifname, const char *buf, size_t len)
+{
+    char path[C_MAXPATH_LEN];
+    char tmp[C_MAXPATH_LEN];
+    FILE *f;
+    bool ok;
+
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST)
+    {
+        LOG(ERR, "dhcpv4_server: Error creating directory %s: %s", dir, strerror(errno));
+        return false;
+    }
+
+    snprintf(path, sizeof(path), "%s/%s", dir, ifname);
+    snprintf(tmp, sizeof(tmp), "%s/.%s.tmp", dir, ifname);
+
+    f = fopen(tmp, "w");
+    if (f == NULL)
+    {
+        LOG(ERR, "dhcpv4_server: Error opening %s: %s", tmp, strerror(errno));
+        return false;
+    }
+
+    ok = fwrite(buf, 1, len, f) == len;
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok || rename(tmp, path) != 0)
+    {
+        LOG(ERR, "dhcpv4_server: Error writing %s: %s", path, strerror(errno));
+        unlink(tmp);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * dnsmasq re-reads dhcp-hostsdir and dhcp-optsdir files by itself, but only
+ * drops removed entries on SIGHUP
+ */
+static void dhcp_conf_reload(void)
+{
+    FILE *f;
+    int pid = 0;
+
+    f = fopen(dhcp_pid_path, "r");
+    if (f == NULL)
+    {
+        LOG(DEBUG, "dhcpv4_server: dnsmasq is not running, no reload needed.");
+        return;
+    }
+
+    if (fscanf(f, "%d", &pid) != 1) pid = 0;
+    fclose(f);
+
+    if (pid <= 0 || kill(pid, SIGHUP) != 0)
+    {
+        LOG(ERR, "dhcpv4_server: Error reloading dnsmasq (pid %d).", pid);
+        return;
+    }
+
+    LOG(INFO, "dhcpv4_server: dnsmasq reloaded.");
+}
+
+/*
+ * Write a rendered file unless its content is the same as the last time
+ */
+static bool dhcp_conf_section_update(
+        const char *dir,
+        const char *ifname,
+        const char *buf,
+        size_t len,
+        uint64_t *last_hash,
+        bool *changed)
+{
+    uint64_t hash = dhcp_conf_hash(buf, len);
+
+    *changed = false;
+    if (hash == *last_hash) return true;
+
+    if (!dhcp_conf_write(dir, ifname, buf, len)) return false;
+
+    *last_hash = hash;
+    *changed = true;
+
+    return true;
+}
+
+/*
+ * Write reservations and options of the server which changed since the last
+ * apply, in dnsmasq dhcp-hostsfile and dhcp-optsfile formats, and reload
+ * dnsmasq if any file content actually changed
+ */
+static bool dhcp_conf_render(osn_dhcp_server_t *self)
+{
+    struct dhcp_reservation *rs;
+    char *buf = NULL;
+    size_t len = 0;
+    bool reload = false;
+    bool retval = true;
+    bool changed;
+    FILE *f;
+    int opt;
+
+    if (self->ds_resv_dirty)
+    {
+        f = open_memstream(&buf, &len);
+        if (f == NULL) return false;
+
+        ds_tree_foreach(&self->ds_resv_mac, rs)
+        {
+            fprintf(f, PRI_osn_mac_addr","PRI_osn_ip_addr,
+                    FMT_osn_mac_addr(rs->rs_macaddr),
+                    FMT_osn_ip_addr(rs->rs_ipaddr));
+            if (rs->rs_hostname[0] != '\0') fprintf(f, ",%s", rs->rs_hostname);
+            fprintf(f, "\n");
+        }
+        fclose(f);
+
+        if (!dhcp_conf_section_update(dhcp_hosts_dir, self->ds_ifname, buf, len,
+                                      &self->ds_resv_hash, &changed))
+        {
+            retval = false;
+        }
+        else
+        {
+            self->ds_resv_dirty = false;
+            if (changed)
+            {
+                LOG(INFO, "dhcpv4_server: %s: Reservations updated.", self->ds_ifname);
+                reload = true;
+            }
+        }
+        free(buf);
+        buf = NULL;
+    }
+
+    if (self->ds_opts_dirty)
+    {
+        f = open_memstream(&buf, &len);
+        if (f == NULL) return false;
+
+        /* dnsmasq tags each request with the name of the interface it came from */
+        for (opt = 0; opt < DHCP_OPTION_MAX; opt++)
+        {
+            if (self->ds_options[opt] == NULL) continue;
+            fprintf(f, "tag:%s,%d,%s\n", self->ds_ifname, opt, self->ds_options[opt]);
+        }
+        fclose(f);
+
+        if (!dhcp_conf_section_update(dhcp_opts_dir, self->ds_ifname, buf, len,
+                                      &self->ds_opts_hash, &changed))
+        {
+            retval = false;
+        }
+        else
+        {
+            self->ds_opts_dirty = false;
+            if (changed)
+            {
+                LOG(INFO, "dhcpv4_server: %s: Options updated.", self->ds_ifname);
+                reload = true;
+            }
+        }
+        free(buf);
+    }
+
+    if (reload) dhcp_conf_reload();
+
+    return retval;
+}
+
+/*
+ * Remove the rendered files of a deleted server
+ */
+static void dhcp_conf_remove(osn_dhcp_server_t *self)
+{
+    char path[C_MAXPATH_LEN];
+    bool reload = false;
+
+    snprintf(path, sizeof(path), "%s/%s", dhcp_hosts_dir, self->ds_ifname);
+    if (unlink(path) == 0) reload = true;
+
+    snprintf(path, sizeof(path), "%s/%s", dhcp_opts_dir, self->ds_ifname);
+    if (unlink(path) == 0) reload = true;
+
+    if (reload) dhcp_conf_reload();
+}
+
 /*
  * Clear leases associated with the server instance -- lease information
  * is cached using the osn_dhcp_server_status structure
@@ -313,7 +705,14 @@ static void dhcp_lease_clear(osn_dhcp_server_t *self)
         self->ds_status.ds_leases = NULL;
     }
 
+    if (self->ds_lease_index != NULL)
+    {
+        FREE(self->ds_lease_index);
+        self->ds_lease_index = NULL;
+    }
+
     self->ds_status.ds_leases_len = 0;
+    self->ds_leases_cap = 0;
 }
 
 /*
@@ -336,83 +735,101 @@ void dhcp_server_status_dispatch()
     }
 }
 
-static bool dhcp_server_lease_parse_line(struct osn_dhcp_server_lease *dl, const char *line)
+/*
+ * Split the next space separated field off the line, in place
+ */
+static char *dhcp_lease_field_next(char **line)
 {
-    /*
-     * Regular expression to match a line in the "dhcp.lease" file of the
-     * following format:
-     *
-     * 1461412276 f4:09:d8:89:54:4f 192.168.0.181 android-c992b284e24fdd69 1,33,3,6,15,28,51,58,59 "*" 01:f4:09:d8:89:54:4f
-     */
-    static const char dnsmasq_lease_parse_re[] =
-        "(^[0-9]+) "                            /* 1: Match timestamp */
-        "(([a-fA-F0-9]{2}:?){6}) "              /* 2,3: Match MAC address */
-        "(([0-9]+\\.?){4}) "                    /* 4,5: Match IP address */
-        "(\\*|[a-zA-Z0-9_-]+) "                 /* 6: Match hostname, can be "*" */
-        "(\\*|([0-9]+,?)+) "                    /* 7,8: Match fingerprint, can be "*" */
-        "\"(\\*|[^\"]+)\" "                     /* 9: Match vendor-class, can be "*" */
-        "[^ ]+$";                               /* Match CID, can be "*" */
+    char *field;
+    char *p;
+
+    p = *line;
+    while (*p == ' ') p++;
+    if (*p == '\0') return NULL;
 
-    static bool parse_re_compiled = false;
-    static regex_t parse_re;
+    field = p;
+    while (*p != ' ' && *p != '\0') p++;
+    if (*p == ' ') *p++ = '\0';
 
-    char sleasetime[C_INT32_LEN];
-    char shwaddr[C_MACADDR_LEN];
-    char sipaddr[C_IP4ADDR_LEN];
+    *line = p;
+    return field;
+}
+
+static bool dhcp_lease_field_valid(const char *field, const char *charset)
+{
+    if (strcmp(field, "*") == 0) return true;
 
-    regmatch_t rm[10];
+    return *field != '\0' && field[strspn(field, charset)] == '\0';
+}
 
-    if (!parse_re_compiled && regcomp(&parse_re, dnsmasq_lease_parse_re, REG_EXTENDED) != 0)
+static bool dhcp_server_lease_parse_line(struct osn_dhcp_server_lease *dl, char *line)
+{
+    /*
+     * Parse a line of the "dhcp.lease" file, modified in place. The format is:
+     *
+     * 1461412276 f4:09:d8:89:54:4f 192.168.0.181 android-c992b284e24fdd69 1,33,3,6,15,28,51,58,59 "*" 01:f4:09:d8:89:54:4f
+     *
+     * expiry, MAC, IP, hostname, fingerprint, quoted vendor-class (may contain
+     * spaces) and client-id. Hostname, fingerprint and vendor-class can be "*"
+     * and are copied as is. The plain dnsmasq format without the fingerprint
+     * and vendor-class fields is accepted as well, those are left empty then.
+     *
+     * Fields are checked against the same patterns as the regular expression
+     * this replaces, dhcp_test checks that both give the same result.
+     */
+    char *sleasetime;
+    char *shwaddr;
+    char *sipaddr;
+    char *shostname;
+    char *sfingerprint = NULL;
+    char *svendorclass = NULL;
+    char *p;
+
+    sleasetime = dhcp_lease_field_next(&line);
+    shwaddr = dhcp_lease_field_next(&line);
+    sipaddr = dhcp_lease_field_next(&line);
+    shostname = dhcp_lease_field_next(&line);
+    if (shostname == NULL) goto invalid;
+
+    while (*line == ' ') line++;
+    if (strchr(line, '"') != NULL)
     {
-        LOG(ERR, "dhcpv4_server: Error compiling DHCP lease parsing regular expression.");
-        return false;
+        sfingerprint = dhcp_lease_field_next(&line);
+        if (sfingerprint == NULL || *line != '"') goto invalid;
+
+        /* Vendor-class ends at the closing quote followed by the client-id */
+        svendorclass = ++line;
+        p = strchr(svendorclass, '"');
+        if (p == NULL || p == svendorclass || p[1] != ' ') goto invalid;
+        *p = '\0';
+        line = p + 2;
     }
 
-    parse_re_compiled = true;
+    /* Client-id is required, but not used */
+    if (dhcp_lease_field_next(&line) == NULL) goto invalid;
+    if (dhcp_lease_field_next(&line) != NULL) goto invalid;
+
+    if (sleasetime[strspn(sleasetime, "0123456789")] != '\0') goto invalid;
+    if (shwaddr[strspn(shwaddr, "0123456789abcdefABCDEF:")] != '\0') goto invalid;
+    if (sipaddr[strspn(sipaddr, "0123456789.")] != '\0') goto invalid;
+    if (!dhcp_lease_field_valid(shostname,
+            "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-")) goto invalid;
 
-    /* Parse the lease line using regular expressions */
-    if (regexec(&parse_re, line, ARRAY_LEN(rm), rm, 0) != 0)
+    /* Fingerprint is a list of option numbers, each optionally followed by a comma */
+    if (sfingerprint != NULL && strcmp(sfingerprint, "*") != 0)
     {
-        LOG(ERR, "NM: Invalid DHCP lease line (ignoring): %s", line);
-        return false;
+        if (!dhcp_lease_field_valid(sfingerprint, "0123456789,")) goto invalid;
+        if (sfingerprint[0] == ',' || strstr(sfingerprint, ",,") != NULL) goto invalid;
     }
 
     memset(dl, 0, sizeof(*dl));
 
-    /* Extract the data */
-    os_reg_match_cpy(
-            sleasetime,
-            sizeof(sleasetime),
-            line,
-            rm[1]);
-
-    os_reg_match_cpy(
-            shwaddr,
-            sizeof(shwaddr),
-            line,
-            rm[2]);
-
-    os_reg_match_cpy(
-            sipaddr,
-            sizeof(sipaddr),
-            line, rm[4]);
-
-    os_reg_match_cpy(dl->dl_hostname,
-            sizeof(dl->dl_hostname),
-            line,
-            rm[6]);
-
-    /* Copy the fingerprint */
-    os_reg_match_cpy(dl->dl_fingerprint,
-            sizeof(dl->dl_fingerprint),
-            line,
-            rm[7]);
-
-    /* Copy the vendor-class */
-    os_reg_match_cpy(dl->dl_vendorclass,
-            sizeof(dl->dl_vendorclass),
-            line,
-            rm[9]);
+    strscpy(dl->dl_hostname, shostname, sizeof(dl->dl_hostname));
+    if (sfingerprint != NULL)
+    {
+        strscpy(dl->dl_fingerprint, sfingerprint, sizeof(dl->dl_fingerprint));
+        strscpy(dl->dl_vendorclass, svendorclass, sizeof(dl->dl_vendorclass));
+    }
 
     dl->dl_leasetime = strtod(sleasetime, NULL);
 
@@ -429,30 +846,108 @@ static bool dhcp_server_lease_parse_line(struct osn_dhcp_server_lease *dl, const
     }
 
     return true;
+
+invalid:
+    LOG(ERR, "dhcpv4_server: Invalid DHCP lease line (ignoring)");
+    return false;
 }
 
-static bool lease_exists(struct osn_dhcp_server_status *st, struct osn_dhcp_server_lease *dl)
+/*
+ * Leases are identified by (MAC, IP). We don't really check for timestamp.
+ * We also don't assume the fingerprint or hostname will change.
+ */
+static uint32_t dhcp_lease_hash(const struct osn_dhcp_server_lease *dl)
 {
-    int i;
+    const uint8_t *p;
+    uint32_t hash = 2166136261U;
+    size_t i;
+
+    p = (const uint8_t *)&dl->dl_hwaddr;
+    for (i = 0; i < sizeof(dl->dl_hwaddr); i++) hash = (hash ^ p[i]) * 16777619U;
 
-    for (i = 0; i < st->ds_leases_len; i++)
+    p = (const uint8_t *)&dl->dl_ipaddr;
+    for (i = 0; i < sizeof(dl->dl_ipaddr); i++) hash = (hash ^ p[i]) * 16777619U;
+
+    return hash;
+}
+
+static bool dhcp_lease_key_eq(const struct osn_dhcp_server_lease *a, const struct osn_dhcp_server_lease *b)
+{
+    return memcmp(&a->dl_hwaddr, &b->dl_hwaddr, sizeof(a->dl_hwaddr)) == 0 &&
+           memcmp(&a->dl_ipaddr, &b->dl_ipaddr, sizeof(a->dl_ipaddr)) == 0;
+}
+
+/*
+ * Return the pool index of the lease with the same key, or -1
+ */
+static int dhcp_lease_find(osn_dhcp_server_t *self, const struct osn_dhcp_server_lease *dl)
+{
+    uint32_t mask;
+    uint32_t i;
+    int32_t n;
+
+    if (self->ds_lease_index == NULL) return -1;
+
+    mask = 2 * self->ds_leases_cap - 1;
+    for (i = dhcp_lease_hash(dl) & mask; (n = self->ds_lease_index[i]) >= 0; i = (i + 1) & mask)
     {
-        /* We don't really check for timestamp. We also don't assume the fingerprint
-         * or hostname will change.
-         */
-        if (memcmp(&dl->dl_ipaddr, &st->ds_leases[i].dl_ipaddr, sizeof(dl->dl_ipaddr)))
-        {
-            continue;
-        }
-        if (memcmp(&dl->dl_hwaddr, &st->ds_leases[i].dl_hwaddr, sizeof(dl->dl_hwaddr)))
-        {
-            continue;
-        }
+        if (dhcp_lease_key_eq(&self->ds_status.ds_leases[n], dl)) return n;
+    }
 
-        return true;
+    return -1;
+}
+
+static void dhcp_lease_index_insert(osn_dhcp_server_t *self, int32_t n)
+{
+    uint32_t mask = 2 * self->ds_leases_cap - 1;
+    uint32_t i;
+
+    i = dhcp_lease_hash(&self->ds_status.ds_leases[n]) & mask;
+    while (self->ds_lease_index[i] >= 0) i = (i + 1) & mask;
+
+    self->ds_lease_index[i] = n;
+}
+
+/*
+ * Resize the lease pool to cap entries, which must be a power of 2 and hold
+ * all current leases, and rebuild the index
+ */
+static void dhcp_lease_pool_resize(osn_dhcp_server_t *self, int cap)
+{
+    struct osn_dhcp_server_status *st = &self->ds_status;
+    int32_t n;
+
+    st->ds_leases = REALLOC(st->ds_leases, cap * sizeof(struct osn_dhcp_server_lease));
+    self->ds_leases_cap = cap;
+
+    if (self->ds_lease_index != NULL) FREE(self->ds_lease_index);
+    self->ds_lease_index = MALLOC(2 * cap * sizeof(int32_t));
+    memset(self->ds_lease_index, 0xff, 2 * cap * sizeof(int32_t));
+
+    for (n = 0; n < st->ds_leases_len; n++)
+    {
+        dhcp_lease_index_insert(self, n);
     }
+}
 
-    return false;
+/*
+ * Halve the pool while less than a quarter of it is used
+ */
+static void dhcp_lease_pool_shrink(osn_dhcp_server_t *self)
+{
+    int cap = self->ds_leases_cap;
+
+    while (cap > DHCP_LEASE_RESIZE_QUANTUM && self->ds_status.ds_leases_len < cap / 4)
+    {
+        cap /= 2;
+    }
+
+    if (cap == self->ds_leases_cap) return;
+
+    LOG(DEBUG, "dhcpv4_server: %s: Shrinking lease pool from %d to %d entries.",
+            self->ds_ifname, self->ds_leases_cap, cap);
+
+    dhcp_lease_pool_resize(self, cap);
 }
 
 /*
@@ -462,60 +957,271 @@ static void dhcp_server_lease_add(osn_dhcp_server_t *self, struct osn_dhcp_serve
 {
     struct osn_dhcp_server_status *st = &self->ds_status;
 
-    if (lease_exists(st, dl))
+    if (dhcp_lease_find(self, dl) >= 0)
     {
            LOGT("Lease is already added, skipping.");
            return;
     }
 
-    /* Resize the leases array */
-    if ((st->ds_leases_len % DHCP_LEASE_RESIZE_QUANTUM) == 0)
+    /* Grow the lease pool */
+    if (st->ds_leases_len == self->ds_leases_cap)
     {
-        /* Reallocate buffer */
-        st->ds_leases = REALLOC(
-                st->ds_leases,
-                (st->ds_leases_len + DHCP_LEASE_RESIZE_QUANTUM) * sizeof(struct osn_dhcp_server_lease));
+        dhcp_lease_pool_resize(
+                self,
+                self->ds_leases_cap > 0 ? 2 * self->ds_leases_cap : DHCP_LEASE_RESIZE_QUANTUM);
     }
 
     LOG(DEBUG, "New lease added: "PRI_osn_ip_addr, FMT_osn_ip_addr(dl->dl_ipaddr));
 
-    /* Append to array */
-    st->ds_leases[st->ds_leases_len++] = *dl;
+    /* Append to pool */
+    st->ds_leases[st->ds_leases_len] = *dl;
+    dhcp_lease_index_insert(self, st->ds_leases_len);
+    st->ds_leases_len++;
+}
+
+static int dhcp_range_idx_cmp(const void *_a, const void *_b)
+{
+    const struct dhcp_range_idx *a = _a;
+    const struct dhcp_range_idx *b = _b;
+
+    if (a->ri_start != b->ri_start) return a->ri_start < b->ri_start ? -1 : 1;
+    if (a->ri_stop != b->ri_stop) return a->ri_stop < b->ri_stop ? -1 : 1;
+
+    return 0;
 }
 
+/*
+ * Ranges changed, leases need to be routed again
+ */
+static void dhcp_range_index_invalidate(void)
+{
+    dhcp_range_index_valid = false;
+
+    if (ev_is_active(&dhcp_lease_watcher))
+    {
+        ev_debounce_start(EV_DEFAULT, &dhcp_lease_init_debounce);
+    }
+}
+
+static void dhcp_range_index_build(void)
+{
+    osn_dhcp_server_t *ds;
+    struct dhcp_range *dr;
+    struct dhcp_range_idx *ri;
+    int n = 0;
+    int i;
+
+    ds_dlist_foreach(&dhcp_server_list, ds)
+    {
+        ds_tree_foreach(&ds->ds_range_list, dr)
+        {
+            n++;
+        }
+    }
+
+    if (dhcp_range_index != NULL) FREE(dhcp_range_index);
+    dhcp_range_index = NULL;
+    dhcp_range_index_len = 0;
+
+    if (n > 0)
+    {
+        dhcp_range_index = MALLOC(n * sizeof(*dhcp_range_index));
+
+        ds_dlist_foreach(&dhcp_server_list, ds)
+        {
+            ds_tree_foreach(&ds->ds_range_list, dr)
+            {
+                ri = &dhcp_range_index[dhcp_range_index_len++];
+                ri->ri_start = ntohl(dr->dr_range_start.ia_addr.s_addr);
+                ri->ri_stop = ntohl(dr->dr_range_stop.ia_addr.s_addr);
+                ri->ri_server = ds;
+            }
+        }
+
+        qsort(dhcp_range_index, dhcp_range_index_len, sizeof(*dhcp_range_index), dhcp_range_idx_cmp);
+    }
+
+    for (i = 0; i < dhcp_range_index_len; i++)
+    {
+        dhcp_range_index[i].ri_stop_max = dhcp_range_index[i].ri_stop;
+        if (i == 0) continue;
+
+        if (dhcp_range_index[i - 1].ri_stop_max > dhcp_range_index[i].ri_stop_max)
+        {
+            dhcp_range_index[i].ri_stop_max = dhcp_range_index[i - 1].ri_stop_max;
+        }
+
+        if (dhcp_range_index[i].ri_start <= dhcp_range_index[i - 1].ri_stop &&
+                dhcp_range_index[i].ri_server != dhcp_range_index[i - 1].ri_server)
+        {
+            LOG(WARNING, "dhcpv4_server: IP ranges of %s and %s overlap, leases are routed to one of them.",
+                    dhcp_range_index[i - 1].ri_server->ds_ifname,
+                    dhcp_range_index[i].ri_server->ds_ifname);
+        }
+    }
+
+    dhcp_range_index_valid = true;
+}
+
+/*
+ * Refresh the interface subnet of every server, once per lease file parse
+ */
+static void dhcp_server_subnet_update(void)
+{
+    osn_dhcp_server_t *ds;
+    struct ifaddrs *ifaddr;
+    struct ifaddrs *ifa;
+    uint32_t mask;
+
+    ds_dlist_foreach(&dhcp_server_list, ds)
+    {
+        ds->ds_subnet = 0;
+        ds->ds_netmask = 0;
+    }
+
+    if (getifaddrs(&ifaddr) != 0)
+    {
+        LOG(WARNING, "dhcpv4_server: Error reading interface addresses: %s", strerror(errno));
+        return;
+    }
+
+    for (ifa = ifaddr; ifa != NULL; ifa = ifa->ifa_next)
+    {
+        if (ifa->ifa_addr == NULL || ifa->ifa_netmask == NULL) continue;
+        if (ifa->ifa_addr->sa_family != AF_INET) continue;
+
+        ds_dlist_foreach(&dhcp_server_list, ds)
+        {
+            if (strcmp(ds->ds_ifname, ifa->ifa_name) != 0) continue;
+
+            mask = ntohl(((struct sockaddr_in *)ifa->ifa_netmask)->sin_addr.s_addr);
+            ds->ds_netmask = mask;
+            ds->ds_subnet = ntohl(((struct sockaddr_in *)ifa->ifa_addr)->sin_addr.s_addr) & mask;
+        }
+    }
+
+    freeifaddrs(ifaddr);
+}
+
+/*
+ * Find the server whose IP range contains the lease address. Static leases
+ * and leases left over from a previous range fall back to the server on the
+ * same subnet, or to the only server there is.
+ */
 static osn_dhcp_server_t* dhcp_server_find_by_lease(struct osn_dhcp_server_lease *dl)
 {
     osn_dhcp_server_t *ds;
+    uint32_t addr;
+    int lo;
+    int hi;
+    int mid;
+
+    if (!dhcp_range_index_valid) dhcp_range_index_build();
+
+    if (dhcp_range_index_len == 0)
+    {
+        /* No ranges configured, we don't have a control over DHCP server,
+         * return first found instance.
+         */
+        ds_dlist_foreach(&dhcp_server_list, ds)
+        {
+            return ds;
+        }
+
+        LOG(WARNING, "No dhcp server instance found");
+        return NULL;
+    }
+
+    /* Find the last range starting at or below the address */
+    addr = ntohl(dl->dl_ipaddr.ia_addr.s_addr);
+    lo = 0;
+    hi = dhcp_range_index_len;
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (dhcp_range_index[mid].ri_start <= addr)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    /* Ranges may overlap, walk back while an earlier range can still contain the address */
+    for (mid = lo - 1; mid >= 0 && dhcp_range_index[mid].ri_stop_max >= addr; mid--)
+    {
+        if (addr <= dhcp_range_index[mid].ri_stop) return dhcp_range_index[mid].ri_server;
+    }
 
-    /* Traverse list of server instances*/
     ds_dlist_foreach(&dhcp_server_list, ds)
     {
-        /* As we don't have a control over DHPC server
-        * return first found instance.
-        */
-        return ds;
+        if (ds->ds_netmask != 0 && (addr & ds->ds_netmask) == ds->ds_subnet) return ds;
     }
 
-    LOG(WARNING, "No dhcp server instance found");
+    ds = ds_dlist_head(&dhcp_server_list);
+    if (ds != NULL && ds_dlist_next(&dhcp_server_list, ds) == NULL) return ds;
 
     return NULL;
 }
 
+/*
+ * Read the whole lease file into a buffer reused across parses
+ */
+static char *dhcp_lease_file_read(int fd, size_t *len)
+{
+    static char *buf = NULL;
+    static size_t buf_sz = 0;
+
+    struct stat st;
+    size_t off = 0;
+    ssize_t rc;
+
+    if (fstat(fd, &st) != 0) return NULL;
+
+    /* Leave room for a terminating NUL and for the file growing meanwhile */
+    if (buf == NULL || buf_sz < (size_t)st.st_size + 1)
+    {
+        buf_sz = st.st_size + st.st_size / 4 + 1024;
+        buf = REALLOC(buf, buf_sz);
+    }
+
+    while (off < buf_sz - 1)
+    {
+        rc = read(fd, buf + off, buf_sz - 1 - off);
+        if (rc < 0 && errno == EINTR) continue;
+        if (rc < 0) return NULL;
+        if (rc == 0) break;
+        off += rc;
+    }
+
+    buf[off] = '\0';
+    *len = off;
+
+    return buf;
+}
+
 /*
  * Parse the dnsmasq lease file and update the lease cache
  */
 bool dhcp_lease_parse(void)
 {
     osn_dhcp_server_t *ds;
-    FILE *lf;
-    char line[1024];
+    char raw[DHCP_LEASE_LINE_LOG_MAX];
+    char *buf;
+    char *line;
+    char *eol;
+    size_t len;
+    int lineno = 0;
+    int fd;
 
     bool retval = false;
 
-    lf = fopen(CONFIG_RDK_DHCP_LEASES_PATH, "r");
-    if (lf == NULL)
+    fd = open(dhcp_leases_path, O_RDONLY);
+    if (fd < 0)
     {
-        LOGE("dhcpv4_server: Error opening lease file: %s", CONFIG_RDK_DHCP_LEASES_PATH);
+        LOGE("dhcpv4_server: Error opening lease file: %s", dhcp_leases_path);
         goto exit;
     }
 
@@ -526,19 +1232,38 @@ bool dhcp_lease_parse(void)
      * When the file descriptor is closed, the associated lock should be released
      * as well.
      */
-    if (!os_file_lock(fileno(lf), OS_LOCK_READ))
+    if (!os_file_lock(fd, OS_LOCK_READ))
     {
-        LOGE("dhcpv4_server: Error locking lease file: %s", CONFIG_RDK_DHCP_LEASES_PATH);
+        LOGE("dhcpv4_server: Error locking lease file: %s", dhcp_leases_path);
         goto exit;
     }
 
-    while (fgets(line, sizeof(line), lf) != NULL)
+    buf = dhcp_lease_file_read(fd, &len);
+    if (buf == NULL)
+    {
+        LOGE("dhcpv4_server: Error reading lease file: %s", dhcp_leases_path);
+        goto exit;
+    }
+
+    dhcp_server_subnet_update();
+
+    for (line = buf; line < buf + len; line = eol + 1)
     {
         struct osn_dhcp_server_lease dl;
 
+        eol = strchr(line, '\n');
+        if (eol == NULL) eol = buf + len;
+        *eol = '\0';
+        if (eol > line && eol[-1] == '\r') eol[-1] = '\0';
+
+        lineno++;
+        if (*line == '\0') continue;
+
+        /* The line is split in place, keep a copy to log */
+        strscpy(raw, line, sizeof(raw));
         if (!dhcp_server_lease_parse_line(&dl, line))
         {
-            LOGW("dhcpv4_server: Error parsing DHCP lease line: %s", line);
+            LOGW("dhcpv4_server: Error parsing DHCP lease line %d: %s", lineno, raw);
             continue;
         }
 
@@ -556,60 +1281,143 @@ bool dhcp_lease_parse(void)
 
     retval = true;
 exit:
-    if (lf != NULL) fclose(lf);
+    if (fd >= 0) close(fd);
 
     return retval;
 }
 
 /*
- * Callback function triggered by file status change on the lease file
+ * Compare two leases with the same key (MAC, IP); the lease time is updated
+ * on every renewal and is not considered a change
  */
-void dhcp_lease_onchange(struct ev_loop *loop, ev_stat *w, int revent)
+static bool dhcp_lease_changed(
+        const struct osn_dhcp_server_lease *a,
+        const struct osn_dhcp_server_lease *b)
 {
-    (void)loop;
-    (void)revent;
+    return strcmp(a->dl_hostname, b->dl_hostname) != 0 ||
+           strcmp(a->dl_fingerprint, b->dl_fingerprint) != 0 ||
+           strcmp(a->dl_vendorclass, b->dl_vendorclass) != 0;
+}
+
+/*
+ * Compare the current leases of a server with the ones before the last lease
+ * file change. Returns true if any lease was added, removed or changed.
+ */
+static bool dhcp_lease_diff(osn_dhcp_server_t *self)
+{
+    struct osn_dhcp_server_lease *prev = self->ds_leases_prev;
+    struct osn_dhcp_server_lease *cur = self->ds_status.ds_leases;
+    int ncur = self->ds_status.ds_leases_len;
+    int matched = 0;
+    int removed = 0;
+    int changed = 0;
+    int added;
+    int i;
+    int n;
 
+    for (i = 0; i < self->ds_leases_prev_len; i++)
+    {
+        n = dhcp_lease_find(self, &prev[i]);
+        if (n < 0)
+        {
+            LOG(DEBUG, "dhcpv4_server: %s: Lease removed: "PRI_osn_ip_addr,
+                    self->ds_ifname, FMT_osn_ip_addr(prev[i].dl_ipaddr));
+            removed++;
+            continue;
+        }
+
+        matched++;
+        if (dhcp_lease_changed(&prev[i], &cur[n]))
+        {
+            LOG(DEBUG, "dhcpv4_server: %s: Lease changed: "PRI_osn_ip_addr,
+                    self->ds_ifname, FMT_osn_ip_addr(cur[n].dl_ipaddr));
+            changed++;
+        }
+    }
+
+    added = ncur - matched;
+    if (added + removed + changed == 0) return false;
+
+    LOG(INFO, "dhcpv4_server: %s: Leases updated, %d added, %d removed, %d changed, %d total.",
+            self->ds_ifname, added, removed, changed, ncur);
+
+    return true;
+}
+
+/*
+ * Re-read the lease file and notify only the servers whose leases changed
+ */
+static void dhcp_lease_update(bool parse)
+{
     osn_dhcp_server_t *ds;
 
-    /* Clear all leases */
+    /* Keep the current leases as the previous snapshot, parse into a new pool of the same size */
+    ds_dlist_foreach(&dhcp_server_list, ds)
+    {
+        if (ds->ds_leases_prev != NULL) FREE(ds->ds_leases_prev);
+        ds->ds_leases_prev = ds->ds_status.ds_leases;
+        ds->ds_leases_prev_len = ds->ds_status.ds_leases_len;
+        ds->ds_status.ds_leases = NULL;
+        ds->ds_status.ds_leases_len = 0;
+
+        if (ds->ds_leases_cap > 0) dhcp_lease_pool_resize(ds, ds->ds_leases_cap);
+    }
+
+    if (parse) dhcp_lease_parse();
+
     ds_dlist_foreach(&dhcp_server_list, ds)
     {
-        dhcp_lease_clear(ds);
+        if ((dhcp_lease_diff(ds) || !ds->ds_status_sent) && ds->ds_status_fn != NULL)
+        {
+            ds->ds_status_fn(ds, &ds->ds_status);
+            ds->ds_status_sent = true;
+        }
+
+        if (ds->ds_leases_prev != NULL) FREE(ds->ds_leases_prev);
+        ds->ds_leases_prev = NULL;
+        ds->ds_leases_prev_len = 0;
+
+        dhcp_lease_pool_shrink(ds);
+
+        LOG(DEBUG, "dhcpv4_server: %s: %d leases, pool %zu bytes, index %zu bytes.",
+                ds->ds_ifname,
+                ds->ds_status.ds_leases_len,
+                (size_t)ds->ds_leases_cap * sizeof(struct osn_dhcp_server_lease),
+                (size_t)ds->ds_leases_cap * 2 * sizeof(int32_t));
     }
+}
+
+/*
+ * Callback function triggered by file status change on the lease file
+ */
+void dhcp_lease_onchange(struct ev_loop *loop, ev_stat *w, int revent)
+{
+    (void)loop;
+    (void)revent;
 
     if (w->attr.st_nlink)
     {
         LOGI("dhcpv4_server: Lease file changed.");
-        dhcp_lease_parse();
+        dhcp_lease_update(true);
     }
     else
     {
         LOGI("dhcpv4_server: Lease file removed, flushing all entries.");
+        dhcp_lease_update(false);
     }
-
-    /* Send out status change notifications */
-    dhcp_server_status_dispatch();
 }
 
 
+/*
+ * Runs after the first server is created and whenever ranges change. Leases
+ * are routed again, only servers whose leases moved or changed are notified.
+ */
 void dhcp_lease_init(struct ev_loop *loop, struct ev_debounce *ev, int revent)
 {
     (void)loop;
     (void)revent;
 
-    osn_dhcp_server_t *ds;
-
     LOG(INFO, "DHCP leases initialization");
 
-    /* Clear all leases */
-    ds_dlist_foreach(&dhcp_server_list, ds)
-    {
-        dhcp_lease_clear(ds);
-    }
-
-    dhcp_lease_parse();
-
-    /* Send out status change notifications */
-    dhcp_server_status_dispatch();
-
+    dhcp_lease_update(true);
 }
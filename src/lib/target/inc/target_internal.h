@@ -35,6 +35,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "dpp_survey.h"
 #include "dpp_neighbor.h"
 #include "osn_dhcp.h"
+#include "bsal.h"        // needed only by target_bsal_btm_batch_entry_t
 
 #ifndef CONFIG_RDK_DISABLE_SYNC
 #include <mesh/meshsync_msgs.h>  // needed only by sync_send_security_change()
@@ -144,6 +145,10 @@ typedef struct
         stats_survey_obss_t   survey_obss;
     } stats;
 
+    // Sample of this record in the per-channel survey ring, 0 if none
+    int32_t             radio_index;
+    uint32_t            hist_seq;
+
     // Linked list of survey data
     ds_dlist_node_t     node;
 } stats_survey_record_t;
@@ -161,6 +166,41 @@ typedef struct
 
 typedef stats_capacity_data_t target_capacity_data_t;
 
+/*
+ * HAL entry points used by the capacity sampler. They default to the Wi-Fi
+ * HAL and can be replaced, e.g. by a mock feeding scripted counter sequences.
+ */
+typedef struct
+{
+    INT (*channel_get)(INT radioIndex, ULONG *channel);
+    INT (*channel_stats_get)(INT radioIndex, wifi_channelStats_t *stats, INT num);
+    INT (*traffic_stats_get)(INT radioIndex, wifi_radioTrafficStats2_t *stats);
+} stats_capacity_hal_ops_t;
+
+void                 stats_capacity_hal_ops_set(const stats_capacity_hal_ops_t *ops);
+void                 stats_cleanup(void);
+
+/*
+ * Batched BSS Transition Management requests. Entries with the same
+ * btm_params content share one candidate list. With CONFIG_RDK_BSAL_BTM_ASYNC
+ * the requests are handed to a worker thread: result is then
+ * TARGET_BSAL_BTM_QUEUED, latency_us stays 0 and the HAL outcome is only
+ * logged. target_bsal_bss_tm_request() is always synchronous.
+ */
+#define TARGET_BSAL_BTM_QUEUED      1
+
+typedef struct
+{
+    const char                  *ifname;
+    const uint8_t               *mac_addr;
+    const bsal_btm_params_t     *btm_params;
+    int                          result;        // 0 sent, -1 failed or TARGET_BSAL_BTM_QUEUED
+    uint64_t                     latency_us;    // batch submit to HAL return, if sent
+} target_bsal_btm_batch_entry_t;
+
+int                  target_bsal_bss_tm_request_batch(target_bsal_btm_batch_entry_t *entries,
+                                                      size_t num);
+
 typedef enum
 {
     MACLEARN_TYPE_ETH   = 0,
@@ -183,6 +223,7 @@ radio_cloud_mode_t   radio_cloud_mode_get(void);
 bool                 radio_rops_vstate(struct schema_Wifi_VIF_State *vstate,
                                        const char *radio_ifname);
 void                 radio_trigger_resync(void);
+bool                 radio_state_update(UINT radioIndex);
 INT                  get_radio_cap_index(const wifi_hal_capability_t *cap, INT radioIndex);
 bool                 radio_ifname_to_idx(const char *ifname, INT *outRadioIndex);
 bool                 radio_rops_vconfig(struct schema_Wifi_VIF_Config *vconf,
@@ -30,10 +30,15 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #ifdef CONFIG_RDK_HAS_ASSOC_REQ_IES
 #include <endian.h>
+#endif
+
+#if defined(CONFIG_RDK_HAS_ASSOC_REQ_IES) || defined(CONFIG_RDK_MGMT_FRAME_CB_SUPPORT)
 #include "bm_ieee80211.h"
 #endif
 
 #include <errno.h>
+#include <time.h>
+#include <pthread.h>
 
 /*****************************************************************************/
 
@@ -47,9 +52,12 @@ typedef enum {
     BSAL_BAND_6G
 } bsal_band_t;
 
+#define BSAL_GROUP_IFACE_MAX (MAX_NUM_RADIOS * MAX_NUM_VAP_PER_RADIO)
+
 typedef struct
 {
     bsal_band_t band;
+    INT radio_index;
     bsal_ifconfig_t bsal_cfg;
     wifi_steering_apConfig_t wifihal_cfg;
 } iface_t;
@@ -57,22 +65,38 @@ typedef struct
 typedef struct
 {
     UINT index;
-    size_t iface_number;
-    iface_t *iface;
+    size_t radio_number;
+    size_t iface_number;    // configured ifaces
+    iface_t *iface;         // BSAL_GROUP_IFACE_MAX slots, unused have band == BSAL_BAND_UNINITIALIZED
+    iface_t *ap_index_map[BSAL_GROUP_IFACE_MAX];    // written with g_event_ring.lock held
 } bsal_group_t;
 
 typedef struct
 {
-    uint8_t bssid[BSAL_MAC_ADDR_LEN];
-    char ifname[BSAL_IFNAME_LEN];
-} bsal_neigh_key_t;
+    bsal_neigh_info_t   nr;
+    ds_tree_node_t      dst_node;
+} bsal_neighbor_t;
 
+/*
+ * Neighbor report list of one interface. Changes are pushed to the HAL on
+ * the next BM loop iteration, so a burst of set/remove calls results in one
+ * push. A deferred push the HAL rejects is retried a few times and the
+ * change stays in the list. Without a loop (before target_bsal_init()) the
+ * push is immediate and a failed change is rolled back, as the caller
+ * retries it.
+ */
 typedef struct
 {
-    bsal_neigh_key_t    key;
-    bsal_neigh_info_t   nr;
+    char                ifname[BSAL_IFNAME_LEN];
+    ds_tree_t           neighbors;      // bsal_neighbor_t keyed by bssid
+    uint32_t            count;
+    bool                dirty;
+    bool                pushed;
+    bool                push_failed;    // last push was rejected or impossible
+    uint32_t            retries;        // failed deferred pushes in a row
+    uint32_t            pushed_hash;    // FNV-1a of the last list pushed
     ds_tree_node_t      dst_node;
-} bsal_neighbor_t;
+} bsal_neigh_set_t;
 
 typedef enum {
     BSAL_CHAN_WIDTH_20 = 0,
@@ -82,16 +106,15 @@ typedef enum {
     BSAL_CHAN_WIDTH_UNSUPPORTED
 } bsal_chwidth_t;
 
-static ds_key_cmp_t bssid_ifname_cmp;
-static ds_tree_t    bsal_ifaces_neighbors = DS_TREE_INIT(bssid_ifname_cmp,
-                                                            bsal_neighbor_t,
-                                                            dst_node);
+static ds_tree_t    bsal_neigh_sets = DS_TREE_INIT(ds_str_cmp,
+                                                   bsal_neigh_set_t,
+                                                   dst_node);
 
 static bsal_event_cb_t _bsal_event_cb = NULL;
 
 /*
- * At the moment we support only devices with two VAPs because we don't have
- * RDK-based box with 3+ VAPs.
+ * Single steering group holding any number of VAPs per radio. The group is
+ * pushed to the HAL once every radio has at least one VAP in it.
  */
 static bsal_group_t group;
 
@@ -114,31 +137,164 @@ static c_item_t map_rssi_xing[] =
     C_ITEM_VAL(WIFI_STEERING_RSSI_HIGHER, BSAL_RSSI_HIGHER)
 };
 
+/*
+ * Client capabilities learnt from CONNECT events, keyed by MAC. Entries are
+ * hashed for lookup and kept on an LRU list so the cache stays bounded in
+ * busy venues: entries unused for CONFIG_RDK_BSAL_CLIENT_CACHE_AGE seconds
+ * are dropped and the least recently used entry is evicted when the cache
+ * is full.
+ */
+#define BSAL_CLIENT_CACHE_BUCKETS   256
+
 typedef struct
 {
     uint8_t             mac[BSAL_MAC_ADDR_LEN];
     bsal_client_info_t  client;
-    ds_dlist_node_t     node;
+#ifdef CONFIG_RDK_HAS_ASSOC_REQ_IES
+    // client.assoc_ies and capabilities parsed from them are valid for ies_ap_index
+    bool                ies_valid;
+    INT                 ies_ap_index;
+#endif
+    time_t              last_used;
+    ds_dlist_node_t     hash_node;
+    ds_dlist_node_t     lru_node;   // head is the most recently used
 } bsal_client_info_cache_t;
 
-static ds_dlist_t g_client_info_list = DS_DLIST_INIT(
-        bsal_client_info_cache_t,
-        node);
+static struct
+{
+    bool                initialized;
+    ds_dlist_t          buckets[BSAL_CLIENT_CACHE_BUCKETS];
+    ds_dlist_t          lru;
+    uint32_t            entries;
+
+    // Counters
+    uint64_t            hits;
+    uint64_t            misses;
+    uint64_t            evictions;
+    uint64_t            expirations;
+    uint64_t            ies_fetched;
+    uint64_t            ies_cached;
+} g_client_info_cache;
 
 /*****************************************************************************/
 
+static time_t bsal_time_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec;
+}
+
+static uint64_t bsal_time_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static uint32_t bsal_client_info_hash(const uint8_t *mac)
+{
+    uint32_t hash = 2166136261u;
+    int i;
+
+    // FNV-1a
+    for (i = 0; i < BSAL_MAC_ADDR_LEN; i++)
+    {
+        hash ^= mac[i];
+        hash *= 16777619u;
+    }
+
+    return hash % BSAL_CLIENT_CACHE_BUCKETS;
+}
+
+static void bsal_client_info_cache_init(void)
+{
+    int i;
+
+    if (g_client_info_cache.initialized) return;
+
+    for (i = 0; i < BSAL_CLIENT_CACHE_BUCKETS; i++)
+    {
+        ds_dlist_init(&g_client_info_cache.buckets[i], bsal_client_info_cache_t, hash_node);
+    }
+    ds_dlist_init(&g_client_info_cache.lru, bsal_client_info_cache_t, lru_node);
+
+    g_client_info_cache.initialized = true;
+}
+
+static void bsal_client_info_cache_drop(bsal_client_info_cache_t *client_info_cache)
+{
+    ds_dlist_remove(&g_client_info_cache.buckets[bsal_client_info_hash(client_info_cache->mac)],
+                    client_info_cache);
+    ds_dlist_remove(&g_client_info_cache.lru, client_info_cache);
+    g_client_info_cache.entries--;
+    free(client_info_cache);
+}
+
+static void bsal_client_info_cache_report(void)
+{
+    LOGD("BSAL client info cache: entries=%u hits=%llu misses=%llu evictions=%llu expirations=%llu"
+         " ies_fetched=%llu ies_cached=%llu",
+         g_client_info_cache.entries,
+         (unsigned long long)g_client_info_cache.hits,
+         (unsigned long long)g_client_info_cache.misses,
+         (unsigned long long)g_client_info_cache.evictions,
+         (unsigned long long)g_client_info_cache.expirations,
+         (unsigned long long)g_client_info_cache.ies_fetched,
+         (unsigned long long)g_client_info_cache.ies_cached);
+}
+
+// Make room for a new entry: age out stale entries, then evict LRU if full
+static void bsal_client_info_cache_make_room(void)
+{
+    bsal_client_info_cache_t *client_info_cache;
+    time_t now = bsal_time_now();
+
+    while ((client_info_cache = ds_dlist_tail(&g_client_info_cache.lru)) != NULL)
+    {
+        if (now - client_info_cache->last_used > CONFIG_RDK_BSAL_CLIENT_CACHE_AGE)
+        {
+            g_client_info_cache.expirations++;
+        }
+        else if (g_client_info_cache.entries >= CONFIG_RDK_BSAL_CLIENT_CACHE_MAX)
+        {
+            LOGD("BSAL client info cache full, evicting "MAC_ADDR_FMT,
+                 MAC_ADDR_UNPACK(client_info_cache->mac));
+            g_client_info_cache.evictions++;
+        }
+        else
+        {
+            break;
+        }
+
+        bsal_client_info_cache_drop(client_info_cache);
+    }
+}
+
 static bsal_client_info_cache_t *bsal_find_client_info(const uint8_t *mac)
 {
     bsal_client_info_cache_t *client_info_cache;
+    ds_dlist_t *bucket;
 
-    ds_dlist_foreach(&g_client_info_list, client_info_cache)
+    bsal_client_info_cache_init();
+
+    bucket = &g_client_info_cache.buckets[bsal_client_info_hash(mac)];
+    ds_dlist_foreach(bucket, client_info_cache)
     {
         if (!memcmp(mac, client_info_cache->mac, BSAL_MAC_ADDR_LEN))
         {
+            g_client_info_cache.hits++;
+            client_info_cache->last_used = bsal_time_now();
+            ds_dlist_remove(&g_client_info_cache.lru, client_info_cache);
+            ds_dlist_insert_head(&g_client_info_cache.lru, client_info_cache);
             return client_info_cache;
         }
     }
 
+    g_client_info_cache.misses++;
+
     LOGD("BSAL %02x:%02x:%02x:%02x:%02x:%02x client_info not found",
                mac[0], mac[1], mac[2],
                mac[3], mac[4], mac[5]);
@@ -146,6 +302,44 @@ static bsal_client_info_cache_t *bsal_find_client_info(const uint8_t *mac)
     return NULL;
 }
 
+static bsal_client_info_cache_t *bsal_alloc_client_info(const uint8_t *mac)
+{
+    bsal_client_info_cache_t *client_info_cache;
+
+    bsal_client_info_cache_init();
+    bsal_client_info_cache_make_room();
+
+    client_info_cache = (bsal_client_info_cache_t *)calloc(1, sizeof(*client_info_cache));
+    if (client_info_cache == NULL)
+    {
+        LOGE("BSAL Failed to allocate memory for new client info");
+        return NULL;
+    }
+
+    memcpy(client_info_cache->mac, mac, sizeof(client_info_cache->mac));
+    client_info_cache->last_used = bsal_time_now();
+
+    ds_dlist_insert_tail(&g_client_info_cache.buckets[bsal_client_info_hash(mac)], client_info_cache);
+    ds_dlist_insert_head(&g_client_info_cache.lru, client_info_cache);
+    g_client_info_cache.entries++;
+
+    bsal_client_info_cache_report();
+
+    return client_info_cache;
+}
+
+static void bsal_client_info_cache_flush(void)
+{
+    bsal_client_info_cache_t *client_info_cache;
+
+    if (!g_client_info_cache.initialized) return;
+
+    while ((client_info_cache = ds_dlist_head(&g_client_info_cache.lru)) != NULL)
+    {
+        bsal_client_info_cache_drop(client_info_cache);
+    }
+}
+
 static UINT bsal_convert_max_chwidth(UINT max_chwidth)
 {
     if (max_chwidth <= 3) return max_chwidth;
@@ -166,16 +360,17 @@ static void bsal_client_info_update(const wifi_steering_evConnect_t *connect)
     client_info_cache = bsal_find_client_info(connect->client_mac);
     if (client_info_cache == NULL)  /* Allocate new node */
     {
-        client_info_cache = (bsal_client_info_cache_t *)calloc(1, sizeof(*client_info_cache));
+        client_info_cache = bsal_alloc_client_info(connect->client_mac);
         if (client_info_cache == NULL)
         {
-            LOGE("BSAL Failed to allocate memory for new client info");
             return;
         }
-        memcpy(client_info_cache->mac, connect->client_mac, sizeof(client_info_cache->mac));
-        ds_dlist_insert_tail(&g_client_info_list, client_info_cache);
     }
 
+#ifdef CONFIG_RDK_HAS_ASSOC_REQ_IES
+    // New association, IEs of the previous one are no longer valid
+    client_info_cache->ies_valid = false;
+#endif
     client_info_cache->client.is_BTM_supported = connect->isBTMSupported;
     client_info_cache->client.is_RRM_supported = connect->isRRMSupported;
     switch (connect->bandsCap)
@@ -233,46 +428,871 @@ static void bsal_client_info_remove(const uint8_t *mac)
     {
         return;
     }
-    ds_dlist_remove(&g_client_info_list, client_info_cache);
-    free(client_info_cache);
+    bsal_client_info_cache_drop(client_info_cache);
+}
+
+/*
+ * Associated clients per VAP, kept current by CONNECT, DISCONNECT and RSSI
+ * events so client info queries are answered with a hash lookup. The full
+ * wifi_getApAssociatedDeviceDiagnosticResult3() list is only fetched to
+ * reconcile a VAP whose snapshot is older than BSAL_ASSOC_RECONCILE_SEC,
+ * when the queried client connected after the last reconciliation, or when
+ * the client is not in the snapshot at all, as its CONNECT event may not
+ * have been drained from the event ring yet.
+ *
+ * Every client also keeps a short SNR history fed by RSSI events and
+ * reconciliations, used to answer measurement requests without the HAL.
+ */
+#define BSAL_ASSOC_BUCKETS          64
+#define BSAL_ASSOC_RECONCILE_SEC    5
+#define BSAL_SNR_HIST_LEN           8
+#define BSAL_MEASURE_FRESH_US       (1000 * 1000)
+
+typedef struct
+{
+    uint8_t             mac[BSAL_MAC_ADDR_LEN];
+    bool                synced;     // snr and bytes come from the HAL list
+    bool                seen;       // present in the list being reconciled
+    int32_t             snr;
+    uint64_t            rx_bytes;
+    uint64_t            tx_bytes;
+    int32_t             snr_hist[BSAL_SNR_HIST_LEN];
+    uint64_t            snr_ts_us[BSAL_SNR_HIST_LEN];
+    uint32_t            snr_head;   // next slot to write
+    uint32_t            snr_count;
+    uint64_t            measure_us; // pending measurement request, 0 if none
+    ds_dlist_node_t     node;
+} bsal_assoc_client_t;
+
+typedef struct
+{
+    ds_dlist_t          buckets[BSAL_ASSOC_BUCKETS];
+    uint32_t            clients;
+    time_t              reconciled;  // 0 if never
+} bsal_assoc_ap_t;
+
+static struct
+{
+    bool                initialized;
+    bsal_assoc_ap_t     ap[BSAL_GROUP_IFACE_MAX];
+
+    // Counters
+    uint64_t            lookups;
+    uint64_t            reconciles;
+    uint64_t            measure_cached;
+    uint64_t            measure_hal;
+    uint64_t            measure_failed;
+    uint64_t            measure_done;
+    uint64_t            measure_lat_sum_us;
+    uint64_t            measure_lat_max_us;
+} g_assoc;
+
+static bsal_assoc_ap_t *bsal_assoc_ap_get(INT apIndex)
+{
+    int i;
+    int b;
+
+    if (apIndex < 0 || apIndex >= BSAL_GROUP_IFACE_MAX) return NULL;
+
+    if (!g_assoc.initialized)
+    {
+        for (i = 0; i < BSAL_GROUP_IFACE_MAX; i++)
+        {
+            for (b = 0; b < BSAL_ASSOC_BUCKETS; b++)
+            {
+                ds_dlist_init(&g_assoc.ap[i].buckets[b], bsal_assoc_client_t, node);
+            }
+        }
+        g_assoc.initialized = true;
+    }
+
+    return &g_assoc.ap[apIndex];
+}
+
+static ds_dlist_t *bsal_assoc_bucket(bsal_assoc_ap_t *ap, const uint8_t *mac)
+{
+    return &ap->buckets[bsal_client_info_hash(mac) % BSAL_ASSOC_BUCKETS];
+}
+
+static bsal_assoc_client_t *bsal_assoc_find(bsal_assoc_ap_t *ap, const uint8_t *mac)
+{
+    bsal_assoc_client_t *client;
+
+    ds_dlist_foreach(bsal_assoc_bucket(ap, mac), client)
+    {
+        if (!memcmp(mac, client->mac, BSAL_MAC_ADDR_LEN)) return client;
+    }
+
+    return NULL;
+}
+
+static bsal_assoc_client_t *bsal_assoc_add(INT apIndex, const uint8_t *mac)
+{
+    bsal_assoc_ap_t *ap;
+    bsal_assoc_client_t *client;
+
+    ap = bsal_assoc_ap_get(apIndex);
+    if (ap == NULL) return NULL;
+
+    client = bsal_assoc_find(ap, mac);
+    if (client == NULL)
+    {
+        client = calloc(1, sizeof(*client));
+        if (client == NULL)
+        {
+            LOGE("BSAL Failed to allocate memory for associated client");
+            return NULL;
+        }
+        memcpy(client->mac, mac, sizeof(client->mac));
+        ds_dlist_insert_tail(bsal_assoc_bucket(ap, mac), client);
+        ap->clients++;
+    }
+
+    client->synced = false;
+
+    return client;
+}
+
+static void bsal_assoc_remove(INT apIndex, const uint8_t *mac)
+{
+    bsal_assoc_ap_t *ap;
+    bsal_assoc_client_t *client;
+
+    ap = bsal_assoc_ap_get(apIndex);
+    if (ap == NULL) return;
+
+    client = bsal_assoc_find(ap, mac);
+    if (client == NULL) return;
+
+    ds_dlist_remove(bsal_assoc_bucket(ap, mac), client);
+    ap->clients--;
+    free(client);
+}
+
+static void bsal_assoc_snr_push(bsal_assoc_client_t *client, int32_t snr)
+{
+    client->snr = snr;
+    client->snr_hist[client->snr_head] = snr;
+    client->snr_ts_us[client->snr_head] = bsal_time_us();
+    client->snr_head = (client->snr_head + 1) % BSAL_SNR_HIST_LEN;
+    if (client->snr_count < BSAL_SNR_HIST_LEN) client->snr_count++;
+}
+
+// Newest SNR sample not older than max_age_us
+static bool bsal_assoc_snr_fresh(const bsal_assoc_client_t *client, uint64_t max_age_us, int32_t *snr)
+{
+    uint32_t last;
+
+    if (client->snr_count == 0) return false;
+
+    last = (client->snr_head + BSAL_SNR_HIST_LEN - 1) % BSAL_SNR_HIST_LEN;
+    if (bsal_time_us() - client->snr_ts_us[last] > max_age_us) return false;
+
+    *snr = client->snr_hist[last];
+    return true;
+}
+
+static void bsal_assoc_snr_update(INT apIndex, const uint8_t *mac, int32_t snr, bool measurement)
+{
+    bsal_assoc_ap_t *ap;
+    bsal_assoc_client_t *client;
+    uint64_t latency_us;
+
+    ap = bsal_assoc_ap_get(apIndex);
+    if (ap == NULL) return;
+
+    client = bsal_assoc_find(ap, mac);
+    if (client == NULL) return;
+
+    bsal_assoc_snr_push(client, snr);
+
+    if (measurement && client->measure_us != 0)
+    {
+        latency_us = bsal_time_us() - client->measure_us;
+        client->measure_us = 0;
+
+        g_assoc.measure_done++;
+        g_assoc.measure_lat_sum_us += latency_us;
+        if (latency_us > g_assoc.measure_lat_max_us) g_assoc.measure_lat_max_us = latency_us;
+
+        LOGD("BSAL Client "MAC_ADDR_FMT" measured SNR %d in %lluus",
+             MAC_ADDR_UNPACK(mac), snr, (unsigned long long)latency_us);
+    }
+}
+
+static void bsal_assoc_ap_flush(INT apIndex)
+{
+    bsal_assoc_ap_t *ap;
+    bsal_assoc_client_t *client;
+    int b;
+
+    ap = bsal_assoc_ap_get(apIndex);
+    if (ap == NULL) return;
+
+    for (b = 0; b < BSAL_ASSOC_BUCKETS; b++)
+    {
+        while ((client = ds_dlist_head(&ap->buckets[b])) != NULL)
+        {
+            ds_dlist_remove(&ap->buckets[b], client);
+            free(client);
+        }
+    }
+    ap->clients = 0;
+    ap->reconciled = 0;
+}
+
+static void bsal_assoc_flush(void)
+{
+    INT apIndex;
+
+    if (!g_assoc.initialized) return;
+
+    LOGD("BSAL associated clients: lookups=%llu reconciles=%llu",
+         (unsigned long long)g_assoc.lookups,
+         (unsigned long long)g_assoc.reconciles);
+    LOGD("BSAL client measurements: cached=%llu hal=%llu failed=%llu done=%llu avg=%lluus max=%lluus",
+         (unsigned long long)g_assoc.measure_cached,
+         (unsigned long long)g_assoc.measure_hal,
+         (unsigned long long)g_assoc.measure_failed,
+         (unsigned long long)g_assoc.measure_done,
+         (unsigned long long)(g_assoc.measure_done ? g_assoc.measure_lat_sum_us / g_assoc.measure_done : 0),
+         (unsigned long long)g_assoc.measure_lat_max_us);
+
+    for (apIndex = 0; apIndex < BSAL_GROUP_IFACE_MAX; apIndex++)
+    {
+        bsal_assoc_ap_flush(apIndex);
+    }
+}
+
+// Sync the VAP snapshot with the associated device list from the HAL
+static bool bsal_assoc_reconcile(INT apIndex)
+{
+    wifi_associated_dev3_t *clients = NULL;
+    bsal_assoc_client_t *client;
+    ds_dlist_iter_t qiter;
+    bsal_assoc_ap_t *ap;
+    UINT clients_num = 0;
+    UINT i;
+    int wifi_hal_ret;
+    int b;
+
+    ap = bsal_assoc_ap_get(apIndex);
+    if (ap == NULL) return false;
+
+    wifi_hal_ret = wifi_getApAssociatedDeviceDiagnosticResult3(apIndex, &clients, &clients_num);
+    if (wifi_hal_ret != RETURN_OK)
+    {
+        LOGE("BSAL Failed to fetch clients associated with iface: %d (wifi_getApAssociatedDeviceDiagnosticResult3() "
+             "failed with code %d)", apIndex, wifi_hal_ret);
+        return false;
+    }
+
+    for (b = 0; b < BSAL_ASSOC_BUCKETS; b++)
+    {
+        ds_dlist_foreach(&ap->buckets[b], client) client->seen = false;
+    }
+
+    for (i = 0; i < clients_num; i++)
+    {
+        client = bsal_assoc_add(apIndex, clients[i].cli_MACAddress);
+        if (client == NULL) continue;
+
+        client->synced = true;
+        client->seen = true;
+        client->rx_bytes = clients[i].cli_BytesReceived;
+        client->tx_bytes = clients[i].cli_BytesSent;
+        bsal_assoc_snr_push(client, clients[i].cli_SNR);
+    }
+
+    free(clients);
+
+    // Drop clients the HAL no longer reports (missed DISCONNECT)
+    for (b = 0; b < BSAL_ASSOC_BUCKETS; b++)
+    {
+        for (client = ds_dlist_ifirst(&qiter, &ap->buckets[b]); client != NULL; client = ds_dlist_inext(&qiter))
+        {
+            if (client->seen) continue;
+
+            ds_dlist_iremove(&qiter);
+            ap->clients--;
+            free(client);
+        }
+    }
+
+    ap->reconciled = bsal_time_now();
+    g_assoc.reconciles++;
+
+    LOGI("BSAL Found %u clients associated with iface: %d", clients_num, apIndex);
+
+    return true;
+}
+
+// Called on HAL threads, must be called with g_event_ring.lock held
+static iface_t* group_get_iface_by_ap_index(INT apIndex)
+{
+    if (apIndex < 0 || apIndex >= BSAL_GROUP_IFACE_MAX) return NULL;
+
+    return group.ap_index_map[apIndex];
+}
+
+/*
+ * Steering and management frame callbacks arrive on vendor HAL threads.
+ * Events are converted in place into a preallocated ring of bsal_event_t
+ * slots and handed to BM in batches on the BM event loop (ev_async), so no
+ * BM code and no client cache update runs on a HAL thread and no memory is
+ * allocated per event. When the ring is full, new events are dropped and
+ * counted as overruns.
+ */
+#define BSAL_EVENT_RING_SIZE        128
+#define BSAL_EVENT_LAT_BUCKETS      24      // log2(us)
+#define BSAL_EVENT_REPORT_EVENTS    1024
+
+typedef struct
+{
+    bsal_event_t                event;
+    // Steering events only: VAP the event was received on
+    INT                         ap_index;
+    // CONNECT only: HAL data used to update the client info cache
+    wifi_steering_evConnect_t   connect;
+    // RSSI only: answered from the SNR history, not measured by the HAL
+    bool                        synthesized;
+    uint64_t                    enqueue_us;
+} bsal_event_slot_t;
+
+static struct
+{
+    struct ev_loop             *loop;
+    ev_async                    async;
+    pthread_mutex_t             lock;
+    bsal_event_slot_t          *slots;
+    uint32_t                    head;
+    uint32_t                    count;
+
+    // Counters
+    uint64_t                    queued;
+    uint64_t                    delivered;
+    uint64_t                    overruns;
+    uint32_t                    batch_max;
+    uint32_t                    latency_hist[BSAL_EVENT_LAT_BUCKETS];
+    uint32_t                    latency_num;
+} g_event_ring =
+{
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+#ifdef CONFIG_RDK_MGMT_FRAME_CB_SUPPORT
+static void bsal_action_stats_report(void);
+#endif
+
+#ifdef CONFIG_RDK_HAS_ASSOC_REQ_IES
+static iface_t* group_get_iface_by_name(const char *ifname);
+static bsal_client_info_cache_t *bsal_client_info_capture_ies(INT apIndex, const uint8_t *mac_addr);
+#endif
+
+#if CONFIG_RDK_BSAL_PROBE_COALESCE_MS > 0
+static void bsal_probe_flush_arm(void);
+#endif
+
+// Must be called with g_event_ring.lock held
+static bsal_event_slot_t *bsal_event_ring_reserve(void)
+{
+    bsal_event_slot_t *slot;
+
+    if (g_event_ring.slots == NULL) return NULL;
+
+    if (g_event_ring.count == BSAL_EVENT_RING_SIZE)
+    {
+        g_event_ring.overruns++;
+        return NULL;
+    }
+
+    slot = &g_event_ring.slots[(g_event_ring.head + g_event_ring.count) % BSAL_EVENT_RING_SIZE];
+    memset(&slot->event, 0, sizeof(slot->event));
+    slot->synthesized = false;
+
+    return slot;
+}
+
+// Must be called with g_event_ring.lock held
+static void bsal_event_ring_commit(bsal_event_slot_t *slot)
+{
+    slot->enqueue_us = bsal_time_us();
+    g_event_ring.count++;
+    g_event_ring.queued++;
+}
+
+static void bsal_event_ring_kick(void)
+{
+    if (g_event_ring.loop == NULL) return;
+
+    if (!ev_async_pending(&g_event_ring.async))
+    {
+        ev_async_send(g_event_ring.loop, &g_event_ring.async);
+    }
+}
+
+static void bsal_event_ring_latency_add(uint64_t latency_us)
+{
+    int bucket = 0;
+
+    while (bucket < BSAL_EVENT_LAT_BUCKETS - 1 && (latency_us >> (bucket + 1)) != 0)
+    {
+        bucket++;
+    }
+
+    g_event_ring.latency_hist[bucket]++;
+    g_event_ring.latency_num++;
+}
+
+// Upper bound of the bucket holding the 99th percentile delivery latency
+static uint64_t bsal_event_ring_p99_us(void)
+{
+    uint32_t p99_bucket = 0;
+    uint32_t sum = 0;
+    int b;
+
+    for (b = 0; b < BSAL_EVENT_LAT_BUCKETS; b++)
+    {
+        sum += g_event_ring.latency_hist[b];
+        if ((uint64_t)sum * 100 >= (uint64_t)g_event_ring.latency_num * 99)
+        {
+            p99_bucket = b;
+            break;
+        }
+    }
+
+    return 1ULL << (p99_bucket + 1);
+}
+
+static void bsal_event_ring_report(void)
+{
+    if (g_event_ring.latency_num < BSAL_EVENT_REPORT_EVENTS) return;
+
+    LOGD("BSAL events: queued=%llu delivered=%llu overruns=%llu batch_max=%u p99<%lluus",
+         (unsigned long long)g_event_ring.queued,
+         (unsigned long long)g_event_ring.delivered,
+         (unsigned long long)g_event_ring.overruns,
+         g_event_ring.batch_max,
+         (unsigned long long)bsal_event_ring_p99_us());
+
+#if CONFIG_RDK_BSAL_PROBE_COALESCE_MS > 0
+    LOGD("BSAL probes: received=%llu delivered=%llu merged=%llu",
+         (unsigned long long)g_probe_stats.probes_in,
+         (unsigned long long)g_probe_stats.probes_out,
+         (unsigned long long)g_probe_stats.absorbed);
+#endif
+
+#ifdef CONFIG_RDK_MGMT_FRAME_CB_SUPPORT
+    bsal_action_stats_report();
+#endif
+
+    memset(g_event_ring.latency_hist, 0, sizeof(g_event_ring.latency_hist));
+    g_event_ring.latency_num = 0;
+}
+
+static void bsal_event_ring_drain(EV_P_ ev_async *w, int revents)
+{
+    bsal_event_slot_t *slot;
+    uint64_t now_us;
+    uint32_t head;
+    uint32_t num;
+    uint32_t i;
+
+    pthread_mutex_lock(&g_event_ring.lock);
+    head = g_event_ring.head;
+    num = g_event_ring.count;
+    pthread_mutex_unlock(&g_event_ring.lock);
+
+    // Slots [head, head + num) stay owned by this side until released below
+    now_us = bsal_time_us();
+    for (i = 0; i < num; i++)
+    {
+        slot = &g_event_ring.slots[(head + i) % BSAL_EVENT_RING_SIZE];
+
+        if (slot->event.type == BSAL_EVENT_CLIENT_CONNECT)
+        {
+            bsal_assoc_add(slot->ap_index, slot->event.data.connect.client_addr);
+            bsal_client_info_update(&slot->connect);
+#ifdef CONFIG_RDK_HAS_ASSOC_REQ_IES
+            // IEs are fixed for the association, parse them once now
+            const iface_t *iface = group_get_iface_by_name(slot->event.ifname);
+            if (iface != NULL)
+            {
+                bsal_client_info_capture_ies(iface->wifihal_cfg.apIndex,
+                                             slot->event.data.connect.client_addr);
+            }
+#endif
+        }
+        else if (slot->event.type == BSAL_EVENT_CLIENT_DISCONNECT)
+        {
+            bsal_assoc_remove(slot->ap_index, slot->event.data.disconnect.client_addr);
+            bsal_client_info_remove(slot->event.data.disconnect.client_addr);
+        }
+        else if (slot->event.type == BSAL_EVENT_RSSI_XING)
+        {
+            bsal_assoc_snr_update(slot->ap_index, slot->event.data.rssi_change.client_addr,
+                                  slot->event.data.rssi_change.rssi, false);
+        }
+        else if (slot->event.type == BSAL_EVENT_RSSI && !slot->synthesized)
+        {
+            // A cached answer is already in the history with its real age
+            bsal_assoc_snr_update(slot->ap_index, slot->event.data.rssi.client_addr,
+                                  slot->event.data.rssi.rssi, true);
+        }
+
+        bsal_event_ring_latency_add(now_us - slot->enqueue_us);
+
+        if (_bsal_event_cb != NULL)
+        {
+            _bsal_event_cb(&slot->event);
+        }
+    }
+
+    pthread_mutex_lock(&g_event_ring.lock);
+    g_event_ring.head = (head + num) % BSAL_EVENT_RING_SIZE;
+    g_event_ring.count -= num;
+    g_event_ring.delivered += num;
+    if (num > g_event_ring.batch_max) g_event_ring.batch_max = num;
+    pthread_mutex_unlock(&g_event_ring.lock);
+
+#if CONFIG_RDK_BSAL_PROBE_COALESCE_MS > 0
+    bsal_probe_flush_arm();
+#endif
+
+    bsal_event_ring_report();
 }
 
+static bool bsal_event_ring_init(struct ev_loop *loop)
+{
+    g_event_ring.slots = calloc(BSAL_EVENT_RING_SIZE, sizeof(*g_event_ring.slots));
+    if (g_event_ring.slots == NULL)
+    {
+        LOGE("%s: unable to allocate event ring", __func__);
+        return false;
+    }
+
+    g_event_ring.head = 0;
+    g_event_ring.count = 0;
+    g_event_ring.loop = loop ? loop : EV_DEFAULT;
+
+    ev_async_init(&g_event_ring.async, bsal_event_ring_drain);
+    ev_async_start(g_event_ring.loop, &g_event_ring.async);
+
+#if CONFIG_RDK_BSAL_PROBE_COALESCE_MS > 0
+    bsal_probe_coalesce_init(g_event_ring.loop);
+#endif
+
+    return true;
+}
+
+static void bsal_event_ring_cleanup(void)
+{
+    if (g_event_ring.loop != NULL)
+    {
+#if CONFIG_RDK_BSAL_PROBE_COALESCE_MS > 0
+        bsal_probe_coalesce_cleanup(g_event_ring.loop);
+#endif
+        ev_async_stop(g_event_ring.loop, &g_event_ring.async);
+        g_event_ring.loop = NULL;
+    }
+
+    pthread_mutex_lock(&g_event_ring.lock);
+    free(g_event_ring.slots);
+    g_event_ring.slots = NULL;
+    g_event_ring.count = 0;
+    pthread_mutex_unlock(&g_event_ring.lock);
+}
+
+#if CONFIG_RDK_BSAL_PROBE_COALESCE_MS > 0
+/*
+ * Probe request coalescing. The first probe of a (client, VAP, blocked,
+ * broadcast) tuple is delivered right away and opens a window of
+ * CONFIG_RDK_BSAL_PROBE_COALESCE_MS. Further matching probes within the
+ * window are absorbed; when it closes, one trailing probe carrying the last
+ * RSSI seen is delivered, so BM ends up with the same final RSSI as without
+ * coalescing. Since blocked and broadcast are part of the key, probes are
+ * never merged across a change of either. Entries are kept in a fixed open
+ * addressed table protected by the event ring lock. The flush timer only
+ * runs while at least one window is open; windows are opened from the HAL
+ * thread, so the timer is (re)armed from the ring drain on the loop thread.
+ */
+#define BSAL_PROBE_SLOTS            256
+#define BSAL_PROBE_PROBE_MAX        8
+
+typedef struct
+{
+    bool                used;
+    uint8_t             mac[BSAL_MAC_ADDR_LEN];
+    INT                 apIndex;
+    bool                blocked;
+    bool                ssid_null;
+    uint64_t            start_us;
+    uint32_t            absorbed;
+    UINT                rssi_last;
+    UINT                rssi_max;
+} bsal_probe_window_t;
+
+static bsal_probe_window_t  g_probe_windows[BSAL_PROBE_SLOTS];
+static uint32_t             g_probe_windows_open;
+static ev_timer             g_probe_flush_timer;
+
+static struct
+{
+    uint64_t            probes_in;
+    uint64_t            probes_out;
+    uint64_t            absorbed;
+} g_probe_stats;
+
+static uint32_t bsal_probe_hash(const uint8_t *mac, INT apIndex)
+{
+    uint32_t hash = 2166136261u;
+    int i;
+
+    for (i = 0; i < BSAL_MAC_ADDR_LEN; i++)
+    {
+        hash ^= mac[i];
+        hash *= 16777619u;
+    }
+    hash ^= (uint32_t)apIndex;
+    hash *= 16777619u;
+
+    return hash % BSAL_PROBE_SLOTS;
+}
+
+static bool bsal_probe_window_match(
+        const bsal_probe_window_t *win,
+        const wifi_steering_evProbeReq_t *probe,
+        INT apIndex)
+{
+    return win->apIndex == apIndex
+        && win->blocked == (probe->blocked ? true : false)
+        && win->ssid_null == (probe->broadcast ? true : false)
+        && !memcmp(win->mac, probe->client_mac, BSAL_MAC_ADDR_LEN);
+}
+
+/*
+ * Close a window, queueing its trailing event if it absorbed any probes.
+ * Returns false (and leaves the window open) if the event ring has no room
+ * for the trailing event. Must be called with g_event_ring.lock held.
+ */
+static bool bsal_probe_window_close(bsal_probe_window_t *win, bool *queued)
+{
+    bsal_event_slot_t *slot;
+    const iface_t *iface;
+
+    iface = win->absorbed > 0 ? group_get_iface_by_ap_index(win->apIndex) : NULL;
+    if (iface != NULL)
+    {
+        slot = bsal_event_ring_reserve();
+        if (slot == NULL) return false;
+
+        LOGT("BSAL probe "MAC_ADDR_FMT" on %s: %u probes merged, rssi last=%u max=%u",
+             MAC_ADDR_UNPACK(win->mac), iface->bsal_cfg.ifname,
+             win->absorbed + 1, win->rssi_last, win->rssi_max);
+
+        slot->event.type = BSAL_EVENT_PROBE_REQ;
+        slot->ap_index = win->apIndex;
+        STRSCPY(slot->event.ifname, iface->bsal_cfg.ifname);
+        memcpy(slot->event.data.probe_req.client_addr, win->mac, BSAL_MAC_ADDR_LEN);
+        slot->event.data.probe_req.rssi = win->rssi_last;
+        slot->event.data.probe_req.ssid_null = win->ssid_null;
+        slot->event.data.probe_req.blocked = win->blocked;
+        bsal_event_ring_commit(slot);
+
+        g_probe_stats.absorbed += win->absorbed - 1;
+        g_probe_stats.probes_out++;
+        *queued = true;
+    }
+
+    win->used = false;
+    g_probe_windows_open--;
+    return true;
+}
+
+/*
+ * Returns true if the probe was absorbed into an open window. Sets *queued
+ * if the trailing event of an expired window had to be queued to make room.
+ * Must be called with g_event_ring.lock held.
+ */
+static bool bsal_probe_coalesce(const wifi_steering_event_t *wifi_hal_event, bool *queued)
+{
+    const wifi_steering_evProbeReq_t *probe = &wifi_hal_event->data.probeReq;
+    const uint64_t window_us = CONFIG_RDK_BSAL_PROBE_COALESCE_MS * 1000ULL;
+    bsal_probe_window_t *free_win = NULL;
+    bsal_probe_window_t *win;
+    uint64_t now_us = bsal_time_us();
+    uint32_t pos;
+    int i;
+
+    g_probe_stats.probes_in++;
+
+    pos = bsal_probe_hash(probe->client_mac, wifi_hal_event->apIndex);
+    for (i = 0; i < BSAL_PROBE_PROBE_MAX; i++)
+    {
+        win = &g_probe_windows[(pos + i) % BSAL_PROBE_SLOTS];
+
+        if (!win->used || now_us - win->start_us >= window_us)
+        {
+            if (win->used && bsal_probe_window_match(win, probe, wifi_hal_event->apIndex))
+            {
+                // A newer probe supersedes the trailing event of this client
+                g_probe_stats.absorbed += win->absorbed;
+                win->used = false;
+                g_probe_windows_open--;
+            }
+            if (free_win == NULL || free_win->used) free_win = win;
+            continue;
+        }
+
+        if (!bsal_probe_window_match(win, probe, wifi_hal_event->apIndex)) continue;
+
+        win->absorbed++;
+        win->rssi_last = probe->rssi;
+        if (probe->rssi > win->rssi_max) win->rssi_max = probe->rssi;
+        return true;
+    }
+
+    // An expired window of another client still owes its trailing event
+    if (free_win != NULL && free_win->used && !bsal_probe_window_close(free_win, queued))
+    {
+        free_win = NULL;
+    }
+
+    // Leading edge: deliver and open a window (if there is room for one)
+    if (free_win != NULL)
+    {
+        memset(free_win, 0, sizeof(*free_win));
+        free_win->used = true;
+        memcpy(free_win->mac, probe->client_mac, BSAL_MAC_ADDR_LEN);
+        free_win->apIndex = wifi_hal_event->apIndex;
+        free_win->blocked = probe->blocked ? true : false;
+        free_win->ssid_null = probe->broadcast ? true : false;
+        free_win->start_us = now_us;
+        free_win->rssi_last = probe->rssi;
+        free_win->rssi_max = probe->rssi;
+        g_probe_windows_open++;
+    }
+
+    g_probe_stats.probes_out++;
+    return false;
+}
+
+// Deliver trailing events of the windows that have closed
+static void bsal_probe_flush(EV_P_ ev_timer *w, int revents)
+{
+    const uint64_t window_us = CONFIG_RDK_BSAL_PROBE_COALESCE_MS * 1000ULL;
+    bsal_probe_window_t *win;
+    uint64_t now_us;
+    bool queued = false;
+    bool idle;
+    int i;
+
+    pthread_mutex_lock(&g_event_ring.lock);
+
+    now_us = bsal_time_us();
+    for (i = 0; i < BSAL_PROBE_SLOTS; i++)
+    {
+        win = &g_probe_windows[i];
+        if (!win->used || now_us - win->start_us < window_us) continue;
+
+        // Ring is full, retry on the next tick
+        if (!bsal_probe_window_close(win, &queued)) break;
+    }
+
+    idle = (g_probe_windows_open == 0);
+
+    pthread_mutex_unlock(&g_event_ring.lock);
+
+    if (idle)
+    {
+        ev_timer_stop(EV_A_ w);
+    }
+
+    if (queued)
+    {
+        bsal_event_ring_kick();
+    }
+}
+
+// Start the flush timer if windows were opened since it last went idle
+static void bsal_probe_flush_arm(void)
+{
+    bool open;
+
+    if (ev_is_active(&g_probe_flush_timer)) return;
+
+    pthread_mutex_lock(&g_event_ring.lock);
+    open = (g_probe_windows_open > 0);
+    pthread_mutex_unlock(&g_event_ring.lock);
+
+    if (open)
+    {
+        ev_timer_again(g_event_ring.loop, &g_probe_flush_timer);
+    }
+}
+
+static void bsal_probe_coalesce_init(struct ev_loop *loop)
+{
+    memset(g_probe_windows, 0, sizeof(g_probe_windows));
+    memset(&g_probe_stats, 0, sizeof(g_probe_stats));
+    g_probe_windows_open = 0;
+
+    // Armed by bsal_probe_flush_arm() once the first window opens
+    ev_timer_init(&g_probe_flush_timer, bsal_probe_flush,
+                  CONFIG_RDK_BSAL_PROBE_COALESCE_MS / 1000.0,
+                  CONFIG_RDK_BSAL_PROBE_COALESCE_MS / 1000.0);
+
+    LOGI("BSAL probe coalescing enabled, window %d ms", CONFIG_RDK_BSAL_PROBE_COALESCE_MS);
+}
+
+static void bsal_probe_coalesce_cleanup(struct ev_loop *loop)
+{
+    ev_timer_stop(loop, &g_probe_flush_timer);
+}
+#endif /* CONFIG_RDK_BSAL_PROBE_COALESCE_MS > 0 */
+
 static void process_event(
         UINT steeringgroupIndex,
         wifi_steering_event_t *wifi_hal_event)
 {
+    bsal_event_slot_t *slot = NULL;
     bsal_event_t *bsal_event = NULL;
+    const iface_t *iface;
+    bool queued = false;
     uint32_t val = 0;
-    size_t i;
 
     // If we don't have a callback, just ignore the data
     if (_bsal_event_cb == NULL)
     {
-        goto end;
+        return;
     }
 
-    bsal_event = (bsal_event_t *)calloc(1, sizeof(*bsal_event));
-    if (bsal_event == NULL)
+    pthread_mutex_lock(&g_event_ring.lock);
+
+#if CONFIG_RDK_BSAL_PROBE_COALESCE_MS > 0
+    if (wifi_hal_event->type == WIFI_STEERING_EVENT_PROBE_REQ &&
+        bsal_probe_coalesce(wifi_hal_event, &queued))
     {
-        LOGE("BSAL Failed to allocate memory for new event");
         goto end;
     }
+#endif
 
-    for (i = 0; i < group.iface_number; i++)
+    slot = bsal_event_ring_reserve();
+    if (slot == NULL)
     {
-        if (group.iface[i].band != BSAL_BAND_UNINITIALIZED &&
-            group.iface[i].wifihal_cfg.apIndex == wifi_hal_event->apIndex)
-        {
-            STRSCPY(bsal_event->ifname, group.iface[i].bsal_cfg.ifname);
-            break;
-        }
+        LOGD("BSAL Dropping event %d, event ring is full", wifi_hal_event->type);
+        goto end;
     }
+    bsal_event = &slot->event;
 
-    if (bsal_event->ifname == NULL)
+    iface = group_get_iface_by_ap_index(wifi_hal_event->apIndex);
+    if (iface == NULL)
     {
         LOGD("BSAL Dropping event received for unknown iface (apIndex: %d)", wifi_hal_event->apIndex);
         goto end;
     }
+    STRSCPY(bsal_event->ifname, iface->bsal_cfg.ifname);
+    slot->ap_index = wifi_hal_event->apIndex;
 
     memset(bsal_event->data.connect.assoc_ies, 0, sizeof(bsal_event->data.connect.assoc_ies));
     bsal_event->data.connect.assoc_ies_len = 0;
@@ -323,7 +1343,7 @@ static void process_event(
                &wifi_hal_event->data.connect.client_mac,
                sizeof(bsal_event->data.connect.client_addr));
 
-        bsal_client_info_update(&wifi_hal_event->data.connect);
+        memcpy(&slot->connect, &wifi_hal_event->data.connect, sizeof(slot->connect));
         break;
 
     case WIFI_STEERING_EVENT_CLIENT_DISCONNECT:
@@ -350,8 +1370,6 @@ static void process_event(
         bsal_event->data.disconnect.type = val;
 
         bsal_event->data.disconnect.reason = wifi_hal_event->data.disconnect.reason;
-
-        bsal_client_info_remove(wifi_hal_event->data.disconnect.client_mac);
         break;
 
     case WIFI_STEERING_EVENT_CLIENT_ACTIVITY:
@@ -417,12 +1435,16 @@ static void process_event(
         goto end;
     }
 
-    _bsal_event_cb(bsal_event);
+    bsal_event_ring_commit(slot);
+    queued = true;
 
 end:
-    // Free the memory allocated for event here, as _bsal_event_cb will
-    // allocate the memory and copy the contents
-    free(bsal_event);
+    pthread_mutex_unlock(&g_event_ring.lock);
+
+    if (queued)
+    {
+        bsal_event_ring_kick();
+    }
 }
 
 static bool lookup_ifname(
@@ -434,6 +1456,8 @@ static bool lookup_ifname(
     int ret;
     wifi_radio_operationParam_t radio_params;
 
+    memset(iface, 0, sizeof(*iface));
+
     if (vif_ifname_to_idx(ifcfg->ifname, &s) == false)
     {
         LOGE("BSAL unable to find vap index for %s", ifcfg->ifname);
@@ -473,18 +1497,25 @@ static bool lookup_ifname(
         case WIFI_FREQUENCY_60_BAND:
             iface->band = BSAL_BAND_6G;
             break;
+
+        default:
+            // BSAL_BAND_UNINITIALIZED marks a free group slot, never store it
+            LOGE("BSAL Unsupported band %d of radio #%d (ifname: %s)",
+                 radio_params.band, radio_index, ifcfg->ifname);
+            goto error;
     }
 
     memcpy(&iface->bsal_cfg, ifcfg, sizeof(iface->bsal_cfg));
 
+    iface->radio_index = radio_index;
     iface->wifihal_cfg.apIndex = s;
     iface->wifihal_cfg.utilCheckIntervalSec = iface->bsal_cfg.chan_util_check_sec;
     iface->wifihal_cfg.utilAvgCount = iface->bsal_cfg.chan_util_avg_count;
     iface->wifihal_cfg.inactCheckIntervalSec = iface->bsal_cfg.inact_check_sec;
     iface->wifihal_cfg.inactCheckThresholdSec = iface->bsal_cfg.inact_tmout_sec_normal;
 
-    LOGI("BSAL Found apIndex #%d (ifname: %s, band: %d)", iface->wifihal_cfg.apIndex,
-         iface->bsal_cfg.ifname, iface->band);
+    LOGI("BSAL Found apIndex #%d (ifname: %s, radio: %d, band: %d)", iface->wifihal_cfg.apIndex,
+         iface->bsal_cfg.ifname, iface->radio_index, iface->band);
 
     return true;
 
@@ -496,7 +1527,7 @@ static iface_t* group_get_iface_by_name(const char *ifname)
 {
     size_t i;
 
-    for (i = 0; i < group.iface_number; i++)
+    for (i = 0; i < BSAL_GROUP_IFACE_MAX; i++)
     {
         if (group.iface[i].band != BSAL_BAND_UNINITIALIZED &&
             (strcmp(ifname, group.iface[i].bsal_cfg.ifname) == 0))
@@ -506,6 +1537,22 @@ static iface_t* group_get_iface_by_name(const char *ifname)
     return NULL;
 }
 
+static void group_map_iface(iface_t *slot, bool add)
+{
+    INT apIndex = slot->wifihal_cfg.apIndex;
+
+    if (apIndex < 0 || apIndex >= BSAL_GROUP_IFACE_MAX)
+    {
+        LOGW("BSAL %s: apIndex %d out of range", slot->bsal_cfg.ifname, apIndex);
+        return;
+    }
+
+    // HAL threads look VAPs up under the ring lock, see process_event()
+    pthread_mutex_lock(&g_event_ring.lock);
+    group.ap_index_map[apIndex] = add ? slot : NULL;
+    pthread_mutex_unlock(&g_event_ring.lock);
+}
+
 static bool group_add_iface(const iface_t *iface)
 {
     size_t i;
@@ -515,154 +1562,308 @@ static bool group_add_iface(const iface_t *iface)
         LOGE("BSAL iface: %s is already configured", iface->bsal_cfg.ifname);
         return false;
     }
-    for (i = 0; i < group.iface_number; i++)
+    for (i = 0; i < BSAL_GROUP_IFACE_MAX; i++)
     {
         if (group.iface[i].band == BSAL_BAND_UNINITIALIZED)
         {
-            memcpy(&group.iface[i], &iface, sizeof(group.iface[i]));
+            memcpy(&group.iface[i], iface, sizeof(group.iface[i]));
+            group_map_iface(&group.iface[i], true);
+            group.iface_number++;
             break;
         }
     }
-    if (i == group.iface_number)
+    if (i == BSAL_GROUP_IFACE_MAX)
     {
-        LOGW("BSAL %s: maximum number of radios exceeded", iface->bsal_cfg.ifname);
+        LOGW("BSAL %s: maximum number of ifaces exceeded", iface->bsal_cfg.ifname);
         return false;
     }
 
     return true;
 }
 
+// Every radio has at least one iface in the group
 static bool is_group_initialized()
 {
+    size_t r;
     size_t i;
 
-    for (i = 0; i < group.iface_number; i++)
+    for (r = 0; r < group.radio_number; r++)
     {
-        if (group.iface[i].band == BSAL_BAND_UNINITIALIZED) return false;
+        for (i = 0; i < BSAL_GROUP_IFACE_MAX; i++)
+        {
+            if (group.iface[i].band != BSAL_BAND_UNINITIALIZED &&
+                group.iface[i].radio_index == (INT)r) break;
+        }
+        if (i == BSAL_GROUP_IFACE_MAX) return false;
     }
     return true;
 }
 
 static bool is_group_uninitialized()
+{
+    return group.iface_number == 0;
+}
+
+static bool group_update_iface(const iface_t *iface)
+{
+    iface_t *slot;
+
+    slot = group_get_iface_by_name(iface->bsal_cfg.ifname);
+    if (slot == NULL)
+    {
+        LOGE("BSAL %s iface is not already configured", iface->bsal_cfg.ifname);
+        return false;
+    }
+
+    group_map_iface(slot, false);
+    memcpy(slot, iface, sizeof(*slot));
+    group_map_iface(slot, true);
+
+    return true;
+}
+
+static bool group_remove_iface(const iface_t *iface)
+{
+    iface_t *slot;
+
+    slot = group_get_iface_by_name(iface->bsal_cfg.ifname);
+    if (slot == NULL)
+    {
+        LOGE("BSAL %s iface is not configured", iface->bsal_cfg.ifname);
+        return false;
+    }
+
+    group_map_iface(slot, false);
+    bsal_assoc_ap_flush(slot->wifihal_cfg.apIndex);
+    memset(slot, 0, sizeof(*slot));
+    group.iface_number--;
+
+    return true;
+}
+
+static bool create_wifihal_ap_config_list(wifi_steering_apConfig_t **wifihal_cfg, UINT *num)
 {
     size_t i;
 
-    for (i = 0; i < group.iface_number; i++)
+    *num = 0;
+    *wifihal_cfg = calloc(group.iface_number ? group.iface_number : 1, sizeof(wifi_steering_apConfig_t));
+    if (*wifihal_cfg == NULL)
     {
-        if (group.iface[i].band != BSAL_BAND_UNINITIALIZED) return false;
+        LOGE("BSAL Failed to allocate memory for wifihal ap config");
+        return false;
+    }
+
+    for (i = 0; i < BSAL_GROUP_IFACE_MAX && *num < group.iface_number; i++)
+    {
+        if (group.iface[i].band == BSAL_BAND_UNINITIALIZED) continue;
+
+        memcpy(&(*wifihal_cfg)[*num], &group.iface[i].wifihal_cfg, sizeof(wifi_steering_apConfig_t));
+        (*num)++;
     }
+
     return true;
 }
 
-static bool group_update_iface(const iface_t *iface)
+static void bsal_client_to_wifi_steering_client(
+        const bsal_client_config_t *bsal_cfg,
+        wifi_steering_clientConfig_t *wifihal_cfg)
+{
+    memset(wifihal_cfg, 0, sizeof(*wifihal_cfg));
+    wifihal_cfg->rssiProbeHWM = bsal_cfg->rssi_probe_hwm;
+    wifihal_cfg->rssiProbeLWM = bsal_cfg->rssi_probe_lwm;
+    wifihal_cfg->rssiAuthHWM = bsal_cfg->rssi_auth_hwm;
+    wifihal_cfg->rssiAuthLWM = bsal_cfg->rssi_auth_lwm;
+    wifihal_cfg->rssiInactXing = bsal_cfg->rssi_inact_xing;
+    wifihal_cfg->rssiHighXing = bsal_cfg->rssi_high_xing;
+    wifihal_cfg->rssiLowXing = bsal_cfg->rssi_low_xing;
+    wifihal_cfg->authRejectReason = bsal_cfg->auth_reject_reason;
+}
+
+/*****************************************************************************/
+
+#ifdef CONFIG_RDK_MGMT_FRAME_CB_SUPPORT
+/*
+ * Action frames are filtered by category on the HAL thread before anything
+ * else is done with them. Only categories BM parses are queued, everything
+ * else (Block Ack, SA Query, HT, VHT, ...) is only counted.
+ */
+#define BSAL_ACTION_CATEGORY_MAX    32
+
+typedef struct
+{
+    uint64_t    received[BSAL_ACTION_CATEGORY_MAX + 1];     // last bin: vendor and unknown
+    uint64_t    queued;
+    uint64_t    filtered;
+    uint64_t    malformed;
+    uint64_t    name_lookups;
+} bsal_action_stats_t;
+
+static bsal_action_stats_t g_action_stats;
+
+// apIndex -> ifname for VAPs which are not part of the steering group. The
+// lock also guards g_action_stats, updated on HAL threads.
+static struct
 {
-    size_t i;
+    pthread_mutex_t lock;
+    bool            valid[BSAL_GROUP_IFACE_MAX];
+    CHAR            ifname[BSAL_GROUP_IFACE_MAX][WIFI_HAL_STR_LEN];
+} g_ap_name_cache =
+{
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
 
-    for (i = 0; i < group.iface_number; i++)
+static bool bsal_action_category_wanted(uint8_t category)
+{
+    switch (category)
     {
-        if (group.iface[i].band == iface->band)
-        {
-            memcpy(&group.iface[i], iface, sizeof(group.iface[i]));
+        case WLAN_ACTION_RADIO_MEASUREMENT:
+        case WLAN_ACTION_WNM:
             return true;
-        }
+        default:
+            return false;
     }
+}
 
-    LOGE("BSAL %s iface is not already configured", iface->bsal_cfg.ifname);
-    return false;
+static void bsal_action_stats_inc(uint64_t *counter)
+{
+    pthread_mutex_lock(&g_ap_name_cache.lock);
+    (*counter)++;
+    pthread_mutex_unlock(&g_ap_name_cache.lock);
 }
 
-static bool group_remove_iface(const iface_t *iface)
+static bool bsal_ap_name_get(INT apIndex, CHAR *ifname, size_t ifname_len)
 {
-    size_t i;
+    const iface_t *iface;
+    CHAR name[WIFI_HAL_STR_LEN];
+    INT ret;
 
-    for (i = 0; i < group.iface_number; i++)
+    pthread_mutex_lock(&g_event_ring.lock);
+    iface = group_get_iface_by_ap_index(apIndex);
+    if (iface != NULL)
     {
-        if (group.iface[i].band == iface->band)
-        {
-            memset(&group.iface[i], 0, sizeof(group.iface[i]));
-            return true;
-        }
+        strscpy(ifname, iface->bsal_cfg.ifname, ifname_len);
     }
+    pthread_mutex_unlock(&g_event_ring.lock);
+    if (iface != NULL) return true;
 
-    LOGE("BSAL %s iface is not configured", iface->bsal_cfg.ifname);
-    return false;
-
-}
-
-static bool create_wifihal_ap_config_list(wifi_steering_apConfig_t **wifihal_cfg)
-{
-    size_t i;
+    if (apIndex < 0 || apIndex >= BSAL_GROUP_IFACE_MAX) return false;
 
-    *wifihal_cfg = calloc(group.iface_number, sizeof(wifi_steering_apConfig_t));
-    if (wifihal_cfg == NULL)
+    pthread_mutex_lock(&g_ap_name_cache.lock);
+    if (g_ap_name_cache.valid[apIndex])
     {
-        LOGE("BSAL Failed to allocate memory for wifihal ap config");
-        return false;
+        strscpy(ifname, g_ap_name_cache.ifname[apIndex], ifname_len);
+        pthread_mutex_unlock(&g_ap_name_cache.lock);
+        return true;
     }
+    pthread_mutex_unlock(&g_ap_name_cache.lock);
 
-    for (i = 0; i < group.iface_number; i++)
+    memset(name, 0, sizeof(name));
+    ret = wifi_getApName(apIndex, name);
+    bsal_action_stats_inc(&g_action_stats.name_lookups);
+    if (ret != RETURN_OK)
     {
-        memcpy(*wifihal_cfg, &group.iface[i].wifihal_cfg, sizeof(wifi_steering_apConfig_t));
+        LOGE("%s: failed to get ifname of VAP #%u (wifi_getApName() failed with code %d)",
+                __func__, apIndex, ret);
+        return false;
     }
 
+    pthread_mutex_lock(&g_ap_name_cache.lock);
+    STRSCPY(g_ap_name_cache.ifname[apIndex], name);
+    g_ap_name_cache.valid[apIndex] = true;
+    pthread_mutex_unlock(&g_ap_name_cache.lock);
+
+    strscpy(ifname, name, ifname_len);
     return true;
 }
 
-static void bsal_client_to_wifi_steering_client(
-        const bsal_client_config_t *bsal_cfg,
-        wifi_steering_clientConfig_t *wifihal_cfg)
+static void bsal_ap_name_cache_flush(void)
 {
-    memset(wifihal_cfg, 0, sizeof(*wifihal_cfg));
-    wifihal_cfg->rssiProbeHWM = bsal_cfg->rssi_probe_hwm;
-    wifihal_cfg->rssiProbeLWM = bsal_cfg->rssi_probe_lwm;
-    wifihal_cfg->rssiAuthHWM = bsal_cfg->rssi_auth_hwm;
-    wifihal_cfg->rssiAuthLWM = bsal_cfg->rssi_auth_lwm;
-    wifihal_cfg->rssiInactXing = bsal_cfg->rssi_inact_xing;
-    wifihal_cfg->rssiHighXing = bsal_cfg->rssi_high_xing;
-    wifihal_cfg->rssiLowXing = bsal_cfg->rssi_low_xing;
-    wifihal_cfg->authRejectReason = bsal_cfg->auth_reject_reason;
+    pthread_mutex_lock(&g_ap_name_cache.lock);
+    memset(g_ap_name_cache.valid, 0, sizeof(g_ap_name_cache.valid));
+    pthread_mutex_unlock(&g_ap_name_cache.lock);
 }
 
-/*****************************************************************************/
+static void bsal_action_stats_report(void)
+{
+    bsal_action_stats_t stats;
+
+    pthread_mutex_lock(&g_ap_name_cache.lock);
+    memcpy(&stats, &g_action_stats, sizeof(stats));
+    pthread_mutex_unlock(&g_ap_name_cache.lock);
+
+    LOGD("BSAL action frames: rrm=%llu wnm=%llu queued=%llu filtered=%llu malformed=%llu name_lookups=%llu",
+         (unsigned long long)stats.received[WLAN_ACTION_RADIO_MEASUREMENT],
+         (unsigned long long)stats.received[WLAN_ACTION_WNM],
+         (unsigned long long)stats.queued,
+         (unsigned long long)stats.filtered,
+         (unsigned long long)stats.malformed,
+         (unsigned long long)stats.name_lookups);
+}
 
-#ifdef CONFIG_RDK_MGMT_FRAME_CB_SUPPORT
 static INT mgmt_frame_cb(INT apIndex, UCHAR *sta_mac, UCHAR *frame, UINT len, wifi_mgmtFrameType_t type, wifi_direction_t dir)
 {
-    INT ret;
-    bsal_event_t event;
+    bsal_event_slot_t *slot;
     CHAR ifname[WIFI_HAL_STR_LEN];
+    uint8_t category;
 
     if (type != WIFI_MGMT_FRAME_TYPE_ACTION) return RETURN_OK; // Currently we support action frames only
     if (dir != wifi_direction_uplink) return RETURN_OK; // We only listen for received frames
+    if (frame == NULL || len < IEEE80211_HDRLEN + 1)
+    {
+        bsal_action_stats_inc(&g_action_stats.malformed);
+        return RETURN_ERR;
+    }
+
+    category = frame[IEEE80211_HDRLEN];
+    bsal_action_stats_inc(&g_action_stats.received[category < BSAL_ACTION_CATEGORY_MAX ? category : BSAL_ACTION_CATEGORY_MAX]);
+
+    if (!bsal_action_category_wanted(category))
+    {
+        bsal_action_stats_inc(&g_action_stats.filtered);
+        return RETURN_OK;
+    }
+
     if (len >= BSAL_MAX_ACTION_FRAME_LEN)
     {
         LOGN("Skipping action frame because it's too big (%d vs %d)", len, BSAL_MAX_ACTION_FRAME_LEN);
+        bsal_action_stats_inc(&g_action_stats.malformed);
         return RETURN_ERR;
     }
 
-    LOGT("Received action frame, apIndex=%d, len=%u", apIndex, len);
+    LOGT("Received action frame, apIndex=%d, len=%u, category=%u", apIndex, len, category);
 
-    memset(ifname, 0, sizeof(ifname));
-    ret = wifi_getApName(apIndex, ifname);
-    if (ret != RETURN_OK)
+    if (!bsal_ap_name_get(apIndex, ifname, sizeof(ifname))) return RETURN_ERR;
+
+    pthread_mutex_lock(&g_event_ring.lock);
+
+    slot = bsal_event_ring_reserve();
+    if (slot == NULL)
     {
-        LOGE("%s: failed to get ifname of VAP #%u (wifi_getApName() failed with code %d)",
-                __func__, apIndex, ret);
+        pthread_mutex_unlock(&g_event_ring.lock);
+        LOGD("BSAL Dropping action frame, event ring is full");
         return RETURN_ERR;
     }
 
-    memset(&event, 0, sizeof(event));
-    event.type = BSAL_EVENT_ACTION_FRAME;
-    STRSCPY(event.ifname, ifname);
-    memcpy(event.data.action_frame.data, frame, len);
-    event.data.action_frame.data_len = len;
+    slot->event.type = BSAL_EVENT_ACTION_FRAME;
+    STRSCPY(slot->event.ifname, ifname);
+    memcpy(slot->event.data.action_frame.data, frame, len);
+    slot->event.data.action_frame.data_len = len;
 
-    _bsal_event_cb(&event);
+    bsal_event_ring_commit(slot);
+    pthread_mutex_unlock(&g_event_ring.lock);
+
+    bsal_event_ring_kick();
+    bsal_action_stats_inc(&g_action_stats.queued);
 
     return RETURN_OK;
 }
 #endif
 
+#ifdef CONFIG_RDK_BSAL_BTM_ASYNC
+static void bsal_btm_worker_stop(void);
+#endif
+static void bsal_neigh_cleanup(void);
+
 int target_bsal_init(
         bsal_event_cb_t event_cb,
         struct ev_loop *loop)
@@ -688,14 +1889,20 @@ int target_bsal_init(
         goto error;
     }
 
-    group.iface_number = cap.wifi_prop.numRadios;
-    group.iface = calloc(group.iface_number, sizeof(iface_t));
+    group.radio_number = cap.wifi_prop.numRadios;
+    group.iface_number = 0;
+    group.iface = calloc(BSAL_GROUP_IFACE_MAX, sizeof(iface_t));
     if (!group.iface)
     {
         LOGE("%s:%d: unable to allocate memory", __func__, __LINE__);
         goto error;
     }
 
+    if (!bsal_event_ring_init(loop))
+    {
+        goto error;
+    }
+
     // Register the callback
     ret = wifi_steering_eventRegister(process_event);
     if (ret < 0)
@@ -724,8 +1931,25 @@ int target_bsal_cleanup(void)
 {
     wifi_steering_eventUnregister();
 
+    bsal_neigh_cleanup();
+    bsal_event_ring_cleanup();
+
     _bsal_event_cb = NULL;
     free(group.iface);
+    memset(&group, 0, sizeof(group));
+
+#ifdef CONFIG_RDK_BSAL_BTM_ASYNC
+    bsal_btm_worker_stop();
+#endif
+
+    bsal_client_info_cache_report();
+    bsal_client_info_cache_flush();
+    bsal_assoc_flush();
+
+#ifdef CONFIG_RDK_MGMT_FRAME_CB_SUPPORT
+    bsal_action_stats_report();
+    bsal_ap_name_cache_flush();
+#endif
 
     LOGI("BSAL cleaned up");
 
@@ -736,6 +1960,7 @@ int target_bsal_iface_add(const bsal_ifconfig_t *ifcfg)
 {
     iface_t iface;
     wifi_steering_apConfig_t *wifihal_cfg;
+    UINT wifihal_cfg_num;
 
     if (!lookup_ifname(ifcfg, &iface))
     {
@@ -747,9 +1972,9 @@ int target_bsal_iface_add(const bsal_ifconfig_t *ifcfg)
 
     if (is_group_initialized())
     {
-        if (!create_wifihal_ap_config_list(&wifihal_cfg)) goto error;
+        if (!create_wifihal_ap_config_list(&wifihal_cfg, &wifihal_cfg_num)) goto error;
 
-        int ret = wifi_steering_setGroup(group.index, group.iface_number, wifihal_cfg);
+        int ret = wifi_steering_setGroup(group.index, wifihal_cfg_num, wifihal_cfg);
         free(wifihal_cfg);
         if (ret != RETURN_OK)
         {
@@ -760,7 +1985,7 @@ int target_bsal_iface_add(const bsal_ifconfig_t *ifcfg)
             goto error;
         }
 
-        LOGI("BSAL Ifaces added to group #%u", group.index);
+        LOGI("BSAL %u ifaces added to group #%u", wifihal_cfg_num, group.index);
     }
     else
     {
@@ -777,6 +2002,7 @@ int target_bsal_iface_update(const bsal_ifconfig_t *ifcfg)
 {
     iface_t iface;
     wifi_steering_apConfig_t *wifihal_cfg;
+    UINT wifihal_cfg_num;
 
     if (!lookup_ifname(ifcfg, &iface))
     {
@@ -788,9 +2014,9 @@ int target_bsal_iface_update(const bsal_ifconfig_t *ifcfg)
 
     if (is_group_initialized())
     {
-        if (!create_wifihal_ap_config_list(&wifihal_cfg)) goto error;
+        if (!create_wifihal_ap_config_list(&wifihal_cfg, &wifihal_cfg_num)) goto error;
 
-        int ret = wifi_steering_setGroup(group.index, group.iface_number, wifihal_cfg);
+        int ret = wifi_steering_setGroup(group.index, wifihal_cfg_num, wifihal_cfg);
         free(wifihal_cfg);
         if (ret != RETURN_OK)
         {
@@ -806,7 +2032,7 @@ int target_bsal_iface_update(const bsal_ifconfig_t *ifcfg)
     }
     else
     {
-        LOGI("BSAL Postpone ifaces update until both radios are set");
+        LOGI("BSAL Postpone ifaces update until all radios are set");
     }
 
     return 0;
@@ -818,6 +2044,8 @@ error:
 int target_bsal_iface_remove(const bsal_ifconfig_t *ifcfg)
 {
     iface_t iface;
+    wifi_steering_apConfig_t *wifihal_cfg;
+    UINT wifihal_cfg_num;
 
     if (!lookup_ifname(ifcfg, &iface))
     {
@@ -839,9 +2067,28 @@ int target_bsal_iface_remove(const bsal_ifconfig_t *ifcfg)
 
         LOGI("BSAL Removed group #%u", group.index);
     }
+    else if (is_group_initialized())
+    {
+        // Every radio still has an iface, push the remaining ones
+        if (!create_wifihal_ap_config_list(&wifihal_cfg, &wifihal_cfg_num)) goto error;
+
+        int ret = wifi_steering_setGroup(group.index, wifihal_cfg_num, wifihal_cfg);
+        free(wifihal_cfg);
+        if (ret != RETURN_OK)
+        {
+            LOGE("BSAL Failed to update radio group #%u"
+                 " (wifi_steering_setGroup() failed with code %d)",
+                 group.index,
+                 ret);
+            goto error;
+        }
+
+        LOGI("BSAL %s removed from group #%u, %u ifaces left",
+             ifcfg->ifname, group.index, wifihal_cfg_num);
+    }
     else
     {
-        LOGI("BSAL Postpone iface removal until both radios are removed");
+        LOGI("BSAL Postpone iface removal until all ifaces are removed");
     }
 
     return 0;
@@ -1030,123 +2277,479 @@ static bool bsal_client_set_connected(
         const uint8_t *mac_addr,
         bsal_client_info_t *info)
 {
-    wifi_associated_dev3_t *clients = NULL;
-    UINT clients_num = 0;
-    UINT i = 0;
-    int wifi_hal_ret = 0;
+    bsal_assoc_ap_t *ap;
+    bsal_assoc_client_t *client;
 #ifndef CONFIG_RDK_HAS_ASSOC_REQ_IES
     bsal_client_info_cache_t *client_info_cache;
 #endif
 
-    wifi_hal_ret = wifi_getApAssociatedDeviceDiagnosticResult3(apIndex, &clients, &clients_num);
-    if (wifi_hal_ret != RETURN_OK)
+    ap = bsal_assoc_ap_get(apIndex);
+    if (ap == NULL)
     {
-        LOGE("BSAL Failed to fetch clients associated with iface: %d (wifi_getApAssociatedDeviceDiagnosticResult3() "
-             "failed with code %d)", apIndex, wifi_hal_ret);
+        LOGE("BSAL Unable to check clients associated with iface: %d (apIndex out of range)", apIndex);
         return false;
     }
 
-    LOGI("BSAL Found %u clients associated with iface: %d", clients_num, apIndex);
+    g_assoc.lookups++;
+    client = bsal_assoc_find(ap, mac_addr);
+    // A miss is not trusted: the CONNECT event may still be in the ring
+    if (client == NULL ||
+        ap->reconciled == 0 ||
+        bsal_time_now() - ap->reconciled >= BSAL_ASSOC_RECONCILE_SEC ||
+        !client->synced)
+    {
+        if (!bsal_assoc_reconcile(apIndex)) return false;
+        client = bsal_assoc_find(ap, mac_addr);
+    }
 
     memset(info, 0, sizeof(*info));
-    for (i = 0; i < clients_num; i++)
-    {
-        if (memcmp(mac_addr, &clients[i].cli_MACAddress, sizeof(clients[i].cli_MACAddress)) == 0)
-        {
-            info->connected = true;
-            info->snr = clients[i].cli_SNR;
-            info->tx_bytes = clients[i].cli_BytesSent;
-            info->rx_bytes = clients[i].cli_BytesReceived;
+    if (client == NULL) return true;
+
+    info->connected = true;
+    info->snr = client->snr;
+    info->tx_bytes = client->tx_bytes;
+    info->rx_bytes = client->rx_bytes;
 #ifndef CONFIG_RDK_HAS_ASSOC_REQ_IES
-            client_info_cache = bsal_find_client_info(mac_addr);
-            if (client_info_cache != NULL)
-            {
-                client_info_cache->client.connected = true;
-                client_info_cache->client.snr = clients[i].cli_SNR;
-                client_info_cache->client.rx_bytes = clients[i].cli_BytesReceived;
-                client_info_cache->client.tx_bytes = clients[i].cli_BytesSent;
-                memcpy(info, &client_info_cache->client, sizeof(*info));
-            }
+    client_info_cache = bsal_find_client_info(mac_addr);
+    if (client_info_cache != NULL)
+    {
+        client_info_cache->client.connected = true;
+        client_info_cache->client.snr = client->snr;
+        client_info_cache->client.rx_bytes = client->rx_bytes;
+        client_info_cache->client.tx_bytes = client->tx_bytes;
+        memcpy(info, &client_info_cache->client, sizeof(*info));
+    }
 #endif
-            LOGI("BSAL Client "MAC_ADDR_FMT" is connected apIndex: %d, SNR: %d, rx: %lld, tx: %lld", MAC_ADDR_UNPACK(mac_addr),
-                apIndex, info->snr, info->rx_bytes, info->tx_bytes);
+    LOGI("BSAL Client "MAC_ADDR_FMT" is connected apIndex: %d, SNR: %d, rx: %lld, tx: %lld", MAC_ADDR_UNPACK(mac_addr),
+        apIndex, info->snr, info->rx_bytes, info->tx_bytes);
 
-            break;
+    return true;
+}
+
+static void bsal_btm_request_build(const bsal_btm_params_t *btm_params, wifi_BTMRequest_t *req)
+{
+    unsigned int bss_term_flag = 0;
+    int i = 0;
+
+    memset(req, 0, sizeof(*req));
+
+    if (btm_params->bss_term == true)
+    {
+        bss_term_flag = 1;
+        req->termDuration.tsf = 0;  // imminently
+        req->termDuration.duration = btm_params->bss_term;
+    }
+
+    req->token = 0x10;  // any
+    req->requestMode = BTM_DEFAULT_PREF | btm_params->abridged << 1 | btm_params->disassoc_imminent << 2 | bss_term_flag << 3;
+    req->validityInterval = btm_params->valid_int;
+    req->numCandidates = btm_params->num_neigh;
+
+    assert(btm_params->num_neigh < MAX_CANDIDATES);
+
+    // Build neighbor list
+    for (i = 0; i < btm_params->num_neigh; i++)
+    {
+        const bsal_neigh_info_t *neigh = &btm_params->neigh[i];
+
+        memcpy(&req->candidates[i].bssid, &neigh->bssid, sizeof(neigh->bssid));
+
+        // Reachability 1: A station sending a pre-authentication frame to the BSSID will not receive a response
+        req->candidates[i].info = 0x01;
+        req->candidates[i].opClass = neigh->op_class;
+        req->candidates[i].channel = neigh->channel;
+        req->candidates[i].phyTable = neigh->phy_type;
+
+        // Preference: Ordering of preferences for the BSS transition candidates for this STA
+        req->candidates[i].bssTransitionCandidatePreference.preference = 0x01;
+    }
+}
+
+/*
+ * Batched BTM requests. Candidate lists are built once per distinct
+ * btm_params content and shared by all clients of the batch steered to the
+ * same set. The built batch is a self-contained job, so it can be submitted
+ * either on the caller thread or on the BTM worker thread.
+ */
+typedef struct
+{
+    INT                 ap_index;
+    CHAR                ifname[WIFI_HAL_STR_LEN];
+    mac_address_t       mac;
+    uint32_t            req_idx;
+    size_t              entry_idx;  // index in the caller's batch
+} bsal_btm_job_entry_t;
+
+typedef struct
+{
+    uint32_t                num;
+    uint32_t                req_num;
+    wifi_BTMRequest_t      *reqs;
+    bsal_btm_job_entry_t   *entries;
+    uint64_t                enqueue_us;
+    ds_dlist_node_t         node;
+} bsal_btm_job_t;
+
+static uint32_t bsal_btm_params_hash(const bsal_btm_params_t *p)
+{
+    uint32_t hash = 2166136261u;
+    uint32_t vals[5];
+    const uint8_t *data;
+    size_t len;
+    size_t i;
+    int n;
+
+#define BSAL_FNV_ADD(_data, _len) \
+    for (data = (const uint8_t *)(_data), len = (_len), i = 0; i < len; i++) \
+    { \
+        hash ^= data[i]; \
+        hash *= 16777619u; \
+    }
+
+    vals[0] = p->valid_int;
+    vals[1] = p->abridged;
+    vals[2] = p->disassoc_imminent;
+    vals[3] = p->bss_term;
+    vals[4] = p->num_neigh;
+    BSAL_FNV_ADD(vals, sizeof(vals));
+
+    for (n = 0; n < p->num_neigh; n++)
+    {
+        const bsal_neigh_info_t *neigh = &p->neigh[n];
+
+        BSAL_FNV_ADD(neigh->bssid, sizeof(neigh->bssid));
+        vals[0] = neigh->op_class;
+        vals[1] = neigh->channel;
+        vals[2] = neigh->phy_type;
+        BSAL_FNV_ADD(vals, 3 * sizeof(vals[0]));
+    }
+
+#undef BSAL_FNV_ADD
+
+    return hash;
+}
+
+static bool bsal_btm_params_equal(const bsal_btm_params_t *a, const bsal_btm_params_t *b)
+{
+    int n;
+
+    if (a == b) return true;
+
+    if (a->valid_int != b->valid_int ||
+        a->abridged != b->abridged ||
+        a->disassoc_imminent != b->disassoc_imminent ||
+        a->bss_term != b->bss_term ||
+        a->num_neigh != b->num_neigh)
+    {
+        return false;
+    }
+
+    for (n = 0; n < a->num_neigh; n++)
+    {
+        if (memcmp(a->neigh[n].bssid, b->neigh[n].bssid, sizeof(a->neigh[n].bssid)) ||
+            a->neigh[n].op_class != b->neigh[n].op_class ||
+            a->neigh[n].channel != b->neigh[n].channel ||
+            a->neigh[n].phy_type != b->neigh[n].phy_type)
+        {
+            return false;
         }
     }
 
-    free(clients);
     return true;
 }
 
-int target_bsal_bss_tm_request(
-        const char *ifname,
-        const uint8_t *mac_addr,
-        const bsal_btm_params_t *btm_params)
+static void bsal_btm_job_free(bsal_btm_job_t *job)
 {
-    const iface_t *iface = NULL;
-    wifi_BTMRequest_t req;
-    unsigned int bss_term_flag = 0;
-    int i = 0;
-    int ret = 0;
-    mac_address_t mac = {0};
+    if (job == NULL) return;
+
+    free(job->reqs);
+    free(job->entries);
+    free(job);
+}
+
+static bsal_btm_job_t *bsal_btm_job_build(target_bsal_btm_batch_entry_t *entries, size_t num)
+{
+    const bsal_btm_params_t **req_params = NULL;
+    uint32_t *req_hashes = NULL;
+    uint32_t req_num = 0;
+    bsal_btm_job_t *job;
+    const iface_t *iface;
+    uint32_t hash;
+    uint32_t r;
+    size_t i;
+
+    job = calloc(1, sizeof(*job));
+    if (job == NULL) goto error;
+
+    job->entries = calloc(num, sizeof(*job->entries));
+    req_params = calloc(num, sizeof(*req_params));
+    req_hashes = calloc(num, sizeof(*req_hashes));
+    if (job->entries == NULL || req_params == NULL || req_hashes == NULL) goto error;
+
+    // First pass: map every entry to a distinct btm_params content
+    for (i = 0; i < num; i++)
+    {
+        target_bsal_btm_batch_entry_t *entry = &entries[i];
+        bsal_btm_job_entry_t *job_entry;
+
+        entry->result = -1;
+        entry->latency_us = 0;
+
+        iface = group_get_iface_by_name(entry->ifname);
+        if (iface == NULL)
+        {
+            LOGE("BSAL Unable to prepare BTM request for client "MAC_ADDR_FMT" (failed to find iface: %s)",
+                 MAC_ADDR_UNPACK(entry->mac_addr), entry->ifname);
+            continue;
+        }
+
+        hash = bsal_btm_params_hash(entry->btm_params);
+        for (r = 0; r < req_num; r++)
+        {
+            if (req_hashes[r] == hash && bsal_btm_params_equal(req_params[r], entry->btm_params)) break;
+        }
+        if (r == req_num)
+        {
+            req_params[r] = entry->btm_params;
+            req_hashes[r] = hash;
+            req_num++;
+        }
+
+        job_entry = &job->entries[job->num++];
+        job_entry->ap_index = iface->wifihal_cfg.apIndex;
+        STRSCPY(job_entry->ifname, iface->bsal_cfg.ifname);
+        memcpy(job_entry->mac, entry->mac_addr, sizeof(job_entry->mac));
+        job_entry->req_idx = r;
+        job_entry->entry_idx = i;
+    }
+
+    // Second pass: one (large) wifi_BTMRequest_t per distinct content
+    if (req_num > 0)
+    {
+        job->reqs = calloc(req_num, sizeof(*job->reqs));
+        if (job->reqs == NULL) goto error;
+
+        for (r = 0; r < req_num; r++)
+        {
+            bsal_btm_request_build(req_params[r], &job->reqs[r]);
+        }
+        job->req_num = req_num;
+    }
+
+    free(req_params);
+    free(req_hashes);
+
+    return job;
+
+error:
+    LOGE("BSAL Failed to allocate memory for BTM batch of %zu clients", num);
+    free(req_params);
+    free(req_hashes);
+    bsal_btm_job_free(job);
+    return NULL;
+}
+
+// Submit all requests of a job; entries is NULL when called from the worker
+static uint32_t bsal_btm_job_run(const bsal_btm_job_t *job, target_bsal_btm_batch_entry_t *entries)
+{
+    const bsal_btm_job_entry_t *job_entry;
+    uint64_t latency_us;
+    uint64_t latency_max = 0;
+    uint32_t failed = 0;
+    uint32_t i;
+    int ret;
+
+    for (i = 0; i < job->num; i++)
+    {
+        job_entry = &job->entries[i];
+
+        ret = wifi_setBTMRequest(job_entry->ap_index, (UCHAR *)job_entry->mac, &job->reqs[job_entry->req_idx]);
+        latency_us = bsal_time_us() - job->enqueue_us;
+        if (latency_us > latency_max) latency_max = latency_us;
+
+        if (ret != RETURN_OK)
+        {
+            LOGE("BSAL Failed to send BTM request to client "MAC_ADDR_FMT" on iface: %s (wifi_setBTMRequest() "
+                 "failed with code %d)", MAC_ADDR_UNPACK(job_entry->mac), job_entry->ifname, ret);
+            failed++;
+        }
+        else
+        {
+            LOGI("BSAL Sent BTM request to client "MAC_ADDR_FMT" on iface: %s in %lluus",
+                 MAC_ADDR_UNPACK(job_entry->mac), job_entry->ifname, (unsigned long long)latency_us);
+        }
+
+        if (entries != NULL)
+        {
+            entries[job_entry->entry_idx].result = ret == RETURN_OK ? 0 : -1;
+            entries[job_entry->entry_idx].latency_us = latency_us;
+        }
+    }
+
+    LOGI("BSAL BTM batch: %u clients, %u candidate lists, %u failed, max latency %lluus",
+         job->num, job->req_num, failed, (unsigned long long)latency_max);
+
+    return failed;
+}
+
+#ifdef CONFIG_RDK_BSAL_BTM_ASYNC
+static struct
+{
+    pthread_mutex_t     lock;
+    pthread_cond_t      cond;
+    pthread_t           thread;
+    bool                running;
+    bool                stop;
+    ds_dlist_t          jobs;
+} g_btm_worker =
+{
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void *bsal_btm_worker_main(void *arg)
+{
+    bsal_btm_job_t *job;
+
+    (void)arg;
+
+    pthread_mutex_lock(&g_btm_worker.lock);
+    while (!g_btm_worker.stop)
+    {
+        job = ds_dlist_head(&g_btm_worker.jobs);
+        if (job == NULL)
+        {
+            pthread_cond_wait(&g_btm_worker.cond, &g_btm_worker.lock);
+            continue;
+        }
+        ds_dlist_remove(&g_btm_worker.jobs, job);
+        pthread_mutex_unlock(&g_btm_worker.lock);
+
+        bsal_btm_job_run(job, NULL);
+        bsal_btm_job_free(job);
+
+        pthread_mutex_lock(&g_btm_worker.lock);
+    }
+    pthread_mutex_unlock(&g_btm_worker.lock);
+
+    return NULL;
+}
+
+static bool bsal_btm_worker_queue(bsal_btm_job_t *job)
+{
+    pthread_mutex_lock(&g_btm_worker.lock);
+
+    if (!g_btm_worker.running)
+    {
+        ds_dlist_init(&g_btm_worker.jobs, bsal_btm_job_t, node);
+        g_btm_worker.stop = false;
+        if (pthread_create(&g_btm_worker.thread, NULL, bsal_btm_worker_main, NULL) != 0)
+        {
+            pthread_mutex_unlock(&g_btm_worker.lock);
+            LOGE("BSAL Failed to start BTM worker thread");
+            return false;
+        }
+        g_btm_worker.running = true;
+    }
+
+    ds_dlist_insert_tail(&g_btm_worker.jobs, job);
+    pthread_cond_signal(&g_btm_worker.cond);
+    pthread_mutex_unlock(&g_btm_worker.lock);
+
+    return true;
+}
+
+static void bsal_btm_worker_stop(void)
+{
+    bsal_btm_job_t *job;
 
-    iface = group_get_iface_by_name(ifname);
-    if (iface == NULL)
+    pthread_mutex_lock(&g_btm_worker.lock);
+    if (!g_btm_worker.running)
     {
-        LOGE("BSAL Unable to prepare BTM request for client "MAC_ADDR_FMT" is connected (failed to find iface: %s)",
-             MAC_ADDR_UNPACK(mac_addr), ifname);
-        goto error;
+        pthread_mutex_unlock(&g_btm_worker.lock);
+        return;
     }
+    g_btm_worker.stop = true;
+    pthread_cond_signal(&g_btm_worker.cond);
+    pthread_mutex_unlock(&g_btm_worker.lock);
 
-    memset(&req, 0, sizeof(req));
+    pthread_join(g_btm_worker.thread, NULL);
 
-    if (btm_params->bss_term == true)
+    while ((job = ds_dlist_head(&g_btm_worker.jobs)) != NULL)
     {
-        bss_term_flag = 1;
-        req.termDuration.tsf = 0;  // imminently
-        req.termDuration.duration = btm_params->bss_term;
+        ds_dlist_remove(&g_btm_worker.jobs, job);
+        LOGW("BSAL Dropping BTM batch of %u clients on cleanup", job->num);
+        bsal_btm_job_free(job);
     }
+    g_btm_worker.running = false;
+}
+#endif
 
-    req.token = 0x10;  // any
-    req.requestMode = BTM_DEFAULT_PREF | btm_params->abridged << 1 | btm_params->disassoc_imminent << 2 | bss_term_flag << 3;
-    req.validityInterval = btm_params->valid_int;
-    req.numCandidates = btm_params->num_neigh;
+static int bsal_btm_submit(target_bsal_btm_batch_entry_t *entries, size_t num, bool async)
+{
+    bsal_btm_job_t *job;
+    uint32_t failed;
+    uint32_t i;
 
-    assert(btm_params->num_neigh < MAX_CANDIDATES);
+    if (num == 0) return 0;
 
-    // Build neighbor list
-    for (i = 0; i < btm_params->num_neigh; i++)
+    job = bsal_btm_job_build(entries, num);
+    if (job == NULL)
     {
-        const bsal_neigh_info_t *neigh = &btm_params->neigh[i];
+        for (i = 0; i < num; i++) entries[i].result = -1;
+        return -1;
+    }
 
-        memcpy(&req.candidates[i].bssid, &neigh->bssid, sizeof(neigh->bssid));
+    job->enqueue_us = bsal_time_us();
+    failed = num - job->num;
 
-        // Reachability 1: A station sending a pre-authentication frame to the BSSID will not receive a response
-        req.candidates[i].info = 0x01;
-        req.candidates[i].opClass = neigh->op_class;
-        req.candidates[i].channel = neigh->channel;
-        req.candidates[i].phyTable = neigh->phy_type;
+#ifdef CONFIG_RDK_BSAL_BTM_ASYNC
+    if (async && job->num > 0)
+    {
+        // The worker owns the job once queued, results are set before
+        for (i = 0; i < job->num; i++)
+        {
+            entries[job->entries[i].entry_idx].result = TARGET_BSAL_BTM_QUEUED;
+        }
 
-        // Preference: Ordering of preferences for the BSS transition candidates for this STA
-        req.candidates[i].bssTransitionCandidatePreference.preference = 0x01;
-    }
+        if (bsal_btm_worker_queue(job)) return failed > 0 ? -1 : 0;
 
-    memcpy(mac, mac_addr, sizeof(mac));
-    ret = wifi_setBTMRequest(iface->wifihal_cfg.apIndex, mac, &req);
-    if (ret != RETURN_OK)
-    {
-        LOGE("BSAL Failed to send BTM request to client "MAC_ADDR_FMT" on iface: %s (wifi_setBTMRequest() "
-             "failed with code %d)", MAC_ADDR_UNPACK(mac_addr), iface->bsal_cfg.ifname, ret);
-        goto error;
+        for (i = 0; i < job->num; i++)
+        {
+            entries[job->entries[i].entry_idx].result = -1;
+        }
+        bsal_btm_job_free(job);
+        return -1;
     }
+#else
+    (void)async;
+#endif
 
-    LOGI("BSAL Sent BTM request to client "MAC_ADDR_FMT" on iface: %s", MAC_ADDR_UNPACK(mac_addr), iface->bsal_cfg.ifname);
+    failed += bsal_btm_job_run(job, entries);
+    bsal_btm_job_free(job);
 
-    return 0;
+    return failed > 0 ? -1 : 0;
+}
 
-error:
-    return -1;
+// The caller of a single request acts on its result, so it is always sent synchronously
+int target_bsal_bss_tm_request(
+        const char *ifname,
+        const uint8_t *mac_addr,
+        const bsal_btm_params_t *btm_params)
+{
+    target_bsal_btm_batch_entry_t entry;
+
+    memset(&entry, 0, sizeof(entry));
+    entry.ifname = ifname;
+    entry.mac_addr = mac_addr;
+    entry.btm_params = btm_params;
+
+    return bsal_btm_submit(&entry, 1, false);
+}
+
+int target_bsal_bss_tm_request_batch(target_bsal_btm_batch_entry_t *entries, size_t num)
+{
+    return bsal_btm_submit(entries, num, true);
 }
 
 int target_bsal_rrm_beacon_report_request(
@@ -1373,6 +2976,88 @@ static void set_client_legacy(bsal_client_info_t *info)
     memset(&info->datarate_info, 0, sizeof(info->datarate_info));
     memset(&info->rrm_caps, 0, sizeof(info->rrm_caps));
 }
+
+static void bsal_client_info_parse_ies(bsal_client_info_t *info)
+{
+    const struct element *elem;
+
+    set_client_legacy(info);
+
+    for_each_element(elem, info->assoc_ies, info->assoc_ies_len) {
+        switch (elem->id) {
+            case WLAN_EID_EXT_CAPAB:
+                bm_parse_btm_supported(info, le32toh(*(uint32_t *)elem->data));
+                break;
+            case WLAN_EID_RRM_ENABLED_CAPABILITIES:
+                bm_parse_rrm_supported(info, elem->data[0], elem->data[1], elem->data[4]);
+                break;
+            case WLAN_EID_HT_CAP:
+                bm_parse_ht_cap(info, le16toh(*(uint16_t *)elem->data),
+                    le32toh(*(uint32_t *)&elem->data[3]));
+                break;
+            case WLAN_EID_VHT_CAP:
+                bm_parse_vht_cap(info, le32toh(*(uint32_t *)elem->data), le16toh(*(uint16_t*)&elem->data[4]));
+                break;
+            case WLAN_EID_PWR_CAPABILITY:
+                bm_parse_pwr_cap(info, elem->data[1]);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Fetch association request IEs and store them parsed in the client info cache
+static bsal_client_info_cache_t *bsal_client_info_capture_ies(INT apIndex, const uint8_t *mac_addr)
+{
+    bsal_client_info_cache_t *client_info_cache;
+    CHAR req_ies[1024];
+    UINT req_ies_len = 0;
+    INT ret;
+
+    memset(req_ies, 0, sizeof(req_ies));
+    ret = wifi_getAssociationReqIEs(apIndex, (const mac_address_t *)mac_addr,
+            req_ies, sizeof(req_ies), &req_ies_len);
+    g_client_info_cache.ies_fetched++;
+    if (ret != RETURN_OK)
+    {
+        LOGE("Cannot get association request IEs for MAC %02x:%02x:%02x:%02x:%02x:%02x on apIndex = %d",
+             mac_addr[0], mac_addr[1], mac_addr[2], mac_addr[3], mac_addr[4], mac_addr[5], apIndex);
+        return NULL;
+    }
+
+    if (req_ies_len > sizeof(client_info_cache->client.assoc_ies))
+    {
+        LOGE("%s: The IEs are too big: %d (max: %d)",
+             __func__, req_ies_len, (int)sizeof(client_info_cache->client.assoc_ies));
+        return NULL;
+    }
+
+    client_info_cache = bsal_find_client_info(mac_addr);
+    if (client_info_cache == NULL)
+    {
+        client_info_cache = bsal_alloc_client_info(mac_addr);
+        if (client_info_cache == NULL) return NULL;
+    }
+
+    memcpy(client_info_cache->client.assoc_ies, req_ies, req_ies_len);
+    client_info_cache->client.assoc_ies_len = req_ies_len;
+    bsal_client_info_parse_ies(&client_info_cache->client);
+    client_info_cache->ies_valid = true;
+    client_info_cache->ies_ap_index = apIndex;
+
+    return client_info_cache;
+}
+
+static void bsal_client_info_copy_caps(bsal_client_info_t *info, const bsal_client_info_t *caps)
+{
+    info->is_BTM_supported = caps->is_BTM_supported;
+    info->is_RRM_supported = caps->is_RRM_supported;
+    memcpy(&info->datarate_info, &caps->datarate_info, sizeof(info->datarate_info));
+    memcpy(&info->rrm_caps, &caps->rrm_caps, sizeof(info->rrm_caps));
+    memcpy(info->assoc_ies, caps->assoc_ies, caps->assoc_ies_len);
+    info->assoc_ies_len = caps->assoc_ies_len;
+}
 #endif
 
 int target_bsal_client_info(
@@ -1383,10 +3068,7 @@ int target_bsal_client_info(
     const iface_t *iface = NULL;
     INT apIndex;
 #ifdef CONFIG_RDK_HAS_ASSOC_REQ_IES
-    const struct element *elem;
-    INT ret;
-    CHAR req_ies[1024];
-    UINT req_ies_len;
+    bsal_client_info_cache_t *client_info_cache;
 #endif
 
     iface = group_get_iface_by_name(ifname);
@@ -1409,95 +3091,87 @@ int target_bsal_client_info(
 #ifdef CONFIG_RDK_HAS_ASSOC_REQ_IES
     if (!info->connected) return 0;
 
-    memset(req_ies, 0, sizeof(req_ies));
-    ret = wifi_getAssociationReqIEs(apIndex, (const mac_address_t *)mac_addr,
-            req_ies, sizeof(req_ies), &req_ies_len);
-    if (ret != RETURN_OK)
+    client_info_cache = bsal_find_client_info(mac_addr);
+    if (client_info_cache != NULL && client_info_cache->ies_valid &&
+        client_info_cache->ies_ap_index == apIndex)
     {
-        LOGE("Cannot get association request IEs for MAC %02x:%02x:%02x:%02x:%02x:%02x on apIndex = %d",
-             mac_addr[0], mac_addr[1], mac_addr[2], mac_addr[3], mac_addr[4], mac_addr[5], apIndex);
-        return -1;
+        g_client_info_cache.ies_cached++;
     }
-
-    if (req_ies_len > sizeof(info->assoc_ies))
+    else
     {
-        LOGE("%s: The IEs are too big: %d (max: %d)",
-             __func__, req_ies_len, (int)sizeof(info->assoc_ies));
-        return -1;
+        client_info_cache = bsal_client_info_capture_ies(apIndex, mac_addr);
+        if (client_info_cache == NULL) return -1;
     }
 
-    memcpy(info->assoc_ies, req_ies, req_ies_len);
-    info->assoc_ies_len = req_ies_len;
-
-    set_client_legacy(info);
-
-    for_each_element(elem, req_ies, req_ies_len) {
-        switch (elem->id) {
-            case WLAN_EID_EXT_CAPAB:
-                bm_parse_btm_supported(info, le32toh(*(uint32_t *)elem->data));
-                break;
-            case WLAN_EID_RRM_ENABLED_CAPABILITIES:
-                bm_parse_rrm_supported(info, elem->data[0], elem->data[1], elem->data[4]);
-                break;
-            case WLAN_EID_HT_CAP:
-                bm_parse_ht_cap(info, le16toh(*(uint16_t *)elem->data),
-                    le32toh(*(uint32_t *)&elem->data[3]));
-                break;
-            case WLAN_EID_VHT_CAP:
-                bm_parse_vht_cap(info, le32toh(*(uint32_t *)elem->data), le16toh(*(uint16_t*)&elem->data[4]));
-                break;
-            case WLAN_EID_PWR_CAPABILITY:
-                bm_parse_pwr_cap(info, elem->data[1]);
-                break;
-            default:
-                break;
-        }
-    }
+    bsal_client_info_copy_caps(info, &client_info_cache->client);
 #endif
 
     return 0;
 }
 
-static int bssid_ifname_cmp(const void *_a, const void *_b)
+#define BSAL_NEIGH_RETRY_SEC    1.0
+#define BSAL_NEIGH_RETRY_MAX    5
+
+static ev_timer g_neigh_commit_timer;
+static bool g_neigh_commit_timer_init;
+
+static struct
+{
+    uint64_t    pushes;
+    uint64_t    skipped;
+    uint64_t    failed;
+} g_neigh_stats;
+
+static int bsal_neigh_bssid_cmp(const void *_a, const void *_b)
+{
+    return memcmp(_a, _b, BSAL_MAC_ADDR_LEN);
+}
+
+static bsal_neigh_set_t *bsal_neigh_set_get(const char *ifname, bool create)
 {
-    const bsal_neigh_key_t *a = _a;
-    const bsal_neigh_key_t *b = _b;
-    int rc;
+    bsal_neigh_set_t *set;
 
-    rc = memcmp(&a->bssid, &b->bssid, sizeof(a->bssid));
-    if (rc != 0) return rc;
+    set = ds_tree_find(&bsal_neigh_sets, ifname);
+    if (set != NULL || !create) return set;
 
-    rc = memcmp(&a->ifname, &b->ifname, sizeof(a->ifname));
-    if (rc != 0) return rc;
+    set = calloc(1, sizeof(*set));
+    if (set == NULL)
+    {
+        LOGE("%s:%d: unable to allocate memory", __func__, __LINE__);
+        return NULL;
+    }
 
-    return 0;
+    STRSCPY(set->ifname, ifname);
+    ds_tree_init(&set->neighbors, bsal_neigh_bssid_cmp, bsal_neighbor_t, dst_node);
+    ds_tree_insert(&bsal_neigh_sets, set, set->ifname);
+
+    return set;
 }
 
-static int bsal_send_update_neighbor_list(const char *ifname)
+static int bsal_neigh_set_push(bsal_neigh_set_t *set)
 {
     bsal_neighbor_t         *iface_neighbor;
-    UINT                    iface_neighbors_number = 0;
     wifi_NeighborReport_t   *neighbor_reports = NULL;
     INT                     ap_index;
+    uint32_t                hash = 2166136261u;
     uint32_t                i = 0;
+    size_t                  b;
     INT                     ret;
 
-    ds_tree_foreach(&bsal_ifaces_neighbors, iface_neighbor)
-    {
-        if (!strcmp(iface_neighbor->key.ifname, ifname))
-        {
-            iface_neighbors_number++;
-        }
-    }
-
-    if (!vif_ifname_to_idx(ifname, &ap_index))
+    if (!vif_ifname_to_idx(set->ifname, &ap_index))
     {
+        // Retrying will not help; the next change of the list tries again
+        LOGE("BSAL: %s: unable to find vap index for %s, dropping neighbor list push",
+             __func__, set->ifname);
+        g_neigh_stats.failed++;
+        set->dirty = false;
+        set->push_failed = true;
         return -1;
     }
 
-    if (iface_neighbors_number > 0)
+    if (set->count > 0)
     {
-        neighbor_reports = calloc(iface_neighbors_number, sizeof(wifi_NeighborReport_t));
+        neighbor_reports = calloc(set->count, sizeof(wifi_NeighborReport_t));
         if (!neighbor_reports)
         {
             LOGE("%s:%d: unable to allocate memory", __func__, __LINE__);
@@ -1505,13 +3179,9 @@ static int bsal_send_update_neighbor_list(const char *ifname)
         }
 
         // fill in the wifi_hal list with neighbors
-        ds_tree_foreach(&bsal_ifaces_neighbors, iface_neighbor)
+        ds_tree_foreach(&set->neighbors, iface_neighbor)
         {
-            if (strcmp(iface_neighbor->key.ifname, ifname))
-            {
-                continue;
-            }
-            if (i >= iface_neighbors_number)
+            if (i >= set->count)
             {
                 break;
             }
@@ -1522,34 +3192,150 @@ static int bsal_send_update_neighbor_list(const char *ifname)
             neighbor_reports[i].phyTable = iface_neighbor->nr.phy_type;
             i++;
         }
+
+        // FNV-1a over the list exactly as it would be pushed
+        for (b = 0; b < i * sizeof(wifi_NeighborReport_t); b++)
+        {
+            hash ^= ((const uint8_t *)neighbor_reports)[b];
+            hash *= 16777619u;
+        }
+    }
+
+    set->dirty = false;
+
+    if (set->pushed && set->pushed_hash == hash)
+    {
+        LOGD("BSAL: %s: neighbor list of %s unchanged (%u neighbors), skipping", __func__, set->ifname, i);
+        g_neigh_stats.skipped++;
+        free(neighbor_reports);
+        return 0;
     }
 
-    ret =  wifi_setNeighborReports((UINT)ap_index, iface_neighbors_number, neighbor_reports);
+    ret =  wifi_setNeighborReports((UINT)ap_index, i, neighbor_reports);
     if (neighbor_reports) free(neighbor_reports);
 
     if (ret != RETURN_OK)
     {
-        LOGE("%s: unable to setNeighborReports for %s", __func__, ifname);
+        LOGE("%s: unable to setNeighborReports for %s", __func__, set->ifname);
+        g_neigh_stats.failed++;
+        set->dirty = true;
+        set->push_failed = true;
         return -1;
     }
 
+    g_neigh_stats.pushes++;
+    set->pushed = true;
+    set->pushed_hash = hash;
+    set->push_failed = false;
+    set->retries = 0;
+
+    LOGI("BSAL: %s: pushed %u neighbors on %s", __func__, i, set->ifname);
+
+    return 0;
+}
+
+static void bsal_neigh_commit_cb(EV_P_ ev_timer *w, int revents)
+{
+    bsal_neigh_set_t *set;
+    bool retry = false;
+
+    ds_tree_foreach(&bsal_neigh_sets, set)
+    {
+        if (!set->dirty) continue;
+
+        if (bsal_neigh_set_push(set) == 0 || !set->dirty) continue;
+
+        if (++set->retries >= BSAL_NEIGH_RETRY_MAX)
+        {
+            LOGE("BSAL: %s: giving up on neighbor list of %s after %u attempts",
+                 __func__, set->ifname, set->retries);
+            set->dirty = false;
+            set->retries = 0;
+            continue;
+        }
+        retry = true;
+    }
+
+    if (retry)
+    {
+        ev_timer_set(w, BSAL_NEIGH_RETRY_SEC, 0.0);
+        ev_timer_start(EV_A_ w);
+    }
+}
+
+/*
+ * Mark the set changed; push now if there is no loop to defer to. Only the
+ * immediate push can fail here, a deferred one is retried from the loop.
+ */
+static int bsal_neigh_set_changed(bsal_neigh_set_t *set)
+{
+    set->dirty = true;
+    set->retries = 0;
+
+    if (g_event_ring.loop == NULL) return bsal_neigh_set_push(set);
+
+    if (!g_neigh_commit_timer_init)
+    {
+        ev_timer_init(&g_neigh_commit_timer, bsal_neigh_commit_cb, 0.0, 0.0);
+        g_neigh_commit_timer_init = true;
+    }
+    if (!ev_is_active(&g_neigh_commit_timer))
+    {
+        ev_timer_set(&g_neigh_commit_timer, 0.0, 0.0);
+        ev_timer_start(g_event_ring.loop, &g_neigh_commit_timer);
+    }
+
+    if (set->push_failed)
+    {
+        LOGW("BSAL: %s: previous neighbor list push on %s failed, pushing again", __func__, set->ifname);
+    }
+
     return 0;
 }
 
+static void bsal_neigh_cleanup(void)
+{
+    bsal_neigh_set_t *set;
+    bsal_neighbor_t *iface_neighbor;
+
+    if (g_neigh_commit_timer_init && g_event_ring.loop != NULL)
+    {
+        ev_timer_stop(g_event_ring.loop, &g_neigh_commit_timer);
+    }
+
+    LOGD("BSAL neighbor lists: pushes=%llu skipped=%llu failed=%llu",
+         (unsigned long long)g_neigh_stats.pushes,
+         (unsigned long long)g_neigh_stats.skipped,
+         (unsigned long long)g_neigh_stats.failed);
+
+    while ((set = ds_tree_head(&bsal_neigh_sets)) != NULL)
+    {
+        while ((iface_neighbor = ds_tree_head(&set->neighbors)) != NULL)
+        {
+            ds_tree_remove(&set->neighbors, iface_neighbor);
+            free(iface_neighbor);
+        }
+        ds_tree_remove(&bsal_neigh_sets, set);
+        free(set);
+    }
+}
+
 int target_bsal_rrm_set_neighbor(const char *ifname, const bsal_neigh_info_t *nr)
 {
+    bsal_neigh_set_t    *set;
     bsal_neighbor_t     *iface_neighbor;
-    bsal_neigh_key_t    key;
+    bsal_neigh_info_t   prev;
+    bool                added = false;
     int                 ret;
 
-    memset(&key, 0, sizeof(key));
-    memcpy(key.bssid, nr->bssid, sizeof(key.bssid));
-    STRSCPY(key.ifname, ifname);
+    set = bsal_neigh_set_get(ifname, true);
+    if (set == NULL) return -1;
 
     // Insert or modify neighbor in the list
-    iface_neighbor = ds_tree_find(&bsal_ifaces_neighbors, &key);
+    iface_neighbor = ds_tree_find(&set->neighbors, nr->bssid);
     if (iface_neighbor)
     {
+        memcpy(&prev, &iface_neighbor->nr, sizeof(prev));
         memcpy(&iface_neighbor->nr, nr, sizeof(iface_neighbor->nr));
     }
     else
@@ -1561,38 +3347,41 @@ int target_bsal_rrm_set_neighbor(const char *ifname, const bsal_neigh_info_t *nr
             return -1;
         }
         memcpy(&iface_neighbor->nr, nr, sizeof(iface_neighbor->nr));
-        memcpy(&iface_neighbor->key, &key, sizeof(iface_neighbor->key));
-        ds_tree_insert(&bsal_ifaces_neighbors, iface_neighbor, &iface_neighbor->key);
+        ds_tree_insert(&set->neighbors, iface_neighbor, iface_neighbor->nr.bssid);
+        set->count++;
+        added = true;
     }
 
     LOGD("BSAL: %s: inserted neighbor %s, "MAC_ADDR_FMT, __func__, ifname, MAC_ADDR_UNPACK(nr->bssid));
 
-    ret = bsal_send_update_neighbor_list(ifname);
+    ret = bsal_neigh_set_changed(set);
     if (ret)
     {
-        ds_tree_remove(&bsal_ifaces_neighbors, iface_neighbor);
-        free(iface_neighbor);
+        if (added)
+        {
+            ds_tree_remove(&set->neighbors, iface_neighbor);
+            set->count--;
+            free(iface_neighbor);
+        }
+        else
+        {
+            memcpy(&iface_neighbor->nr, &prev, sizeof(iface_neighbor->nr));
+        }
 
         LOGE("BSAL: %s: failed adding neighbor %s, "MAC_ADDR_FMT, __func__, ifname, MAC_ADDR_UNPACK(nr->bssid));
-        return ret;
     }
 
-    LOGI("BSAL: %s: succesfully added neighbor %s, "MAC_ADDR_FMT, __func__, ifname, MAC_ADDR_UNPACK(nr->bssid));
-
-    return 0;
+    return ret;
 }
 
 int target_bsal_rrm_remove_neighbor(const char *ifname, const bsal_neigh_info_t *nr)
 {
+    bsal_neigh_set_t    *set;
     bsal_neighbor_t     *iface_neighbor;
-    bsal_neigh_key_t    key;
     int                 ret;
 
-    memset(&key, 0, sizeof(key));
-    memcpy(key.bssid, nr->bssid, sizeof(key.bssid));
-    STRSCPY(key.ifname, ifname);
-
-    iface_neighbor = ds_tree_find(&bsal_ifaces_neighbors, &key);
+    set = bsal_neigh_set_get(ifname, false);
+    iface_neighbor = set ? ds_tree_find(&set->neighbors, nr->bssid) : NULL;
     if (!iface_neighbor)
     {
         LOGD("%s: unable to find neighbor bssid="MAC_ADDR_FMT" ifaname=%s", __func__,
@@ -1600,25 +3389,96 @@ int target_bsal_rrm_remove_neighbor(const char *ifname, const bsal_neigh_info_t
         return 0;
     }
 
-    ds_tree_remove(&bsal_ifaces_neighbors, iface_neighbor);
+    ds_tree_remove(&set->neighbors, iface_neighbor);
+    set->count--;
 
-    ret = bsal_send_update_neighbor_list(ifname);
+    LOGD("BSAL: %s: removed neighbor %s, "MAC_ADDR_FMT, __func__, ifname, MAC_ADDR_UNPACK(nr->bssid));
+
+    ret = bsal_neigh_set_changed(set);
     if (ret)
     {
-        ds_tree_insert(&bsal_ifaces_neighbors, iface_neighbor, &key);
+        ds_tree_insert(&set->neighbors, iface_neighbor, iface_neighbor->nr.bssid);
+        set->count++;
+
         LOGE("BSAL: %s: failed removing neighbor %s, "MAC_ADDR_FMT, __func__, ifname, MAC_ADDR_UNPACK(nr->bssid));
         return ret;
     }
-    free(iface_neighbor);
 
-    LOGI("BSAL: %s: succesfully removed neighbor %s, "MAC_ADDR_FMT, __func__, ifname, MAC_ADDR_UNPACK(nr->bssid));
+    free(iface_neighbor);
 
     return 0;
 }
 
+/*
+ * The result is always delivered asynchronously as BSAL_EVENT_RSSI. A fresh
+ * enough sample from the client's SNR history is queued right away, otherwise
+ * the HAL is asked to measure and reports through the steering callback.
+ */
 int target_bsal_client_measure(const char *ifname, const uint8_t *mac_addr,
                                int num_samples)
 {
-    // BM will use last known SNR.
-    return -ENOSYS;
+    const iface_t *iface;
+    bsal_assoc_ap_t *ap;
+    bsal_assoc_client_t *client = NULL;
+    bsal_event_slot_t *slot;
+    mac_address_t mac;
+    int32_t snr;
+    INT apIndex;
+    INT ret;
+
+    (void)num_samples;  // the HAL takes a single measurement
+
+    iface = group_get_iface_by_name(ifname);
+    if (iface == NULL)
+    {
+        LOGE("BSAL Unable to measure client "MAC_ADDR_FMT" (failed to find iface: %s)",
+             MAC_ADDR_UNPACK(mac_addr), ifname);
+        return -1;
+    }
+    apIndex = iface->wifihal_cfg.apIndex;
+
+    ap = bsal_assoc_ap_get(apIndex);
+    if (ap != NULL) client = bsal_assoc_find(ap, mac_addr);
+
+    if (client != NULL && bsal_assoc_snr_fresh(client, BSAL_MEASURE_FRESH_US, &snr))
+    {
+        pthread_mutex_lock(&g_event_ring.lock);
+        slot = bsal_event_ring_reserve();
+        if (slot != NULL)
+        {
+            slot->event.type = BSAL_EVENT_RSSI;
+            STRSCPY(slot->event.ifname, iface->bsal_cfg.ifname);
+            memcpy(slot->event.data.rssi.client_addr, mac_addr, sizeof(slot->event.data.rssi.client_addr));
+            slot->event.data.rssi.rssi = snr;
+            slot->ap_index = apIndex;
+            slot->synthesized = true;
+            bsal_event_ring_commit(slot);
+        }
+        pthread_mutex_unlock(&g_event_ring.lock);
+
+        if (slot != NULL)
+        {
+            bsal_event_ring_kick();
+            g_assoc.measure_cached++;
+            return 0;
+        }
+    }
+
+    // Request to answer latency is only tracked for actual HAL measurements
+    if (client != NULL) client->measure_us = bsal_time_us();
+
+    memcpy(mac, mac_addr, sizeof(mac));
+    ret = wifi_steering_clientMeasure(group.index, apIndex, mac);
+    if (ret != RETURN_OK)
+    {
+        LOGE("BSAL Failed to measure client "MAC_ADDR_FMT" on iface: %s (wifi_steering_clientMeasure() "
+             "failed with code %d)", MAC_ADDR_UNPACK(mac_addr), ifname, ret);
+        if (client != NULL) client->measure_us = 0;
+        g_assoc.measure_failed++;
+        return -1;
+    }
+
+    g_assoc.measure_hal++;
+
+    return 0;
 }
@@ -846,7 +846,7 @@ static bool radio_state_get(
     return true;
 }
 
-static bool radio_state_update(UINT radioIndex)
+bool radio_state_update(UINT radioIndex)
 {
     struct schema_Wifi_Radio_State  rstate;
 
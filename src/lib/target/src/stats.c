@@ -26,6 +26,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <stdio.h>
 #include <errno.h>
+#include <time.h>
+#include <pthread.h>
 
 #include "os.h"
 #include "os_nif.h"
@@ -141,14 +143,155 @@ static radio_chanwidth_t phymode_to_chanwidth(char *phymode)
     return RADIO_CHAN_WIDTH_20MHZ;
 }
 
+/******************************************************************************
+ *  RECORD POOL
+ *****************************************************************************/
+
+/*
+ * Client and survey records are allocated for every sample and released by
+ * SM as soon as the report is built. Released records are kept on a bounded
+ * free list and handed out again on the next sample, so in steady state the
+ * sampling path does not hit malloc/free at all.
+ */
+#define STATS_POOL_CLIENT_MAX      256
+#define STATS_POOL_SURVEY_MAX      (2 * STATS_SURVEY_CHAN_MAX)
+#define STATS_POOL_TRIM_ROUNDS     16
+
+typedef struct stats_pool_item
+{
+    struct stats_pool_item         *next;
+} stats_pool_item_t;
+
+typedef struct
+{
+    const char                     *name;
+    size_t                          size;
+    uint32_t                        free_max;
+    uint32_t                        free_num;
+    stats_pool_item_t              *free_list;
+
+    // Counters
+    uint64_t                        allocs;     // records taken from malloc
+    uint64_t                        reuses;     // records taken from the free list
+    uint64_t                        releases;   // records returned by the caller
+    uint32_t                        in_use;
+    uint32_t                        in_use_peak;
+    uint32_t                        trim_rounds;
+} stats_pool_t;
+
+static stats_pool_t g_client_pool =
+{
+    .name       = "client",
+    .size       = sizeof(stats_client_record_t),
+    .free_max   = STATS_POOL_CLIENT_MAX,
+};
+
+static stats_pool_t g_survey_pool =
+{
+    .name       = "survey",
+    .size       = sizeof(stats_survey_record_t),
+    .free_max   = STATS_POOL_SURVEY_MAX,
+};
+
+static void* stats_pool_get(stats_pool_t *pool)
+{
+    stats_pool_item_t *item = pool->free_list;
+
+    if (item != NULL)
+    {
+        pool->free_list = item->next;
+        pool->free_num--;
+        pool->reuses++;
+        memset(item, 0, pool->size);
+    }
+    else
+    {
+        item = CALLOC(1, pool->size);
+        pool->allocs++;
+    }
+
+    pool->in_use++;
+    if (pool->in_use > pool->in_use_peak)
+    {
+        pool->in_use_peak = pool->in_use;
+    }
+
+    return item;
+}
+
+static void stats_pool_put(stats_pool_t *pool, void *ptr)
+{
+    stats_pool_item_t *item = ptr;
+
+    if (item == NULL) return;
+
+    pool->releases++;
+    if (pool->in_use > 0) pool->in_use--;
+
+    if (pool->free_num >= pool->free_max)
+    {
+        FREE(item);
+        return;
+    }
+
+    item->next = pool->free_list;
+    pool->free_list = item;
+    pool->free_num++;
+}
+
+/*
+ * Release cached records beyond what the last sampling rounds needed, so a
+ * one-off burst (e.g. a venue full of clients) does not pin memory forever.
+ */
+static void stats_pool_trim(stats_pool_t *pool)
+{
+    stats_pool_item_t *item;
+
+    if (++pool->trim_rounds < STATS_POOL_TRIM_ROUNDS) return;
+    pool->trim_rounds = 0;
+
+    while (pool->free_num > 0 && pool->free_num + pool->in_use > pool->in_use_peak)
+    {
+        item = pool->free_list;
+        pool->free_list = item->next;
+        pool->free_num--;
+        FREE(item);
+    }
+
+    pool->in_use_peak = pool->in_use;
+}
+
+static void stats_pool_flush(stats_pool_t *pool)
+{
+    stats_pool_item_t *item;
+
+    while ((item = pool->free_list) != NULL)
+    {
+        pool->free_list = item->next;
+        FREE(item);
+    }
+    pool->free_num = 0;
+}
+
+static void stats_pool_report(stats_pool_t *pool)
+{
+    LOGD("Stats %s pool: in_use=%u cached=%u allocs=%llu reuses=%llu releases=%llu",
+         pool->name,
+         pool->in_use,
+         pool->free_num,
+         (unsigned long long)pool->allocs,
+         (unsigned long long)pool->reuses,
+         (unsigned long long)pool->releases);
+}
+
 static inline stats_survey_record_t* stats_survey_record_alloc()
 {
-    return CALLOC(1, sizeof(stats_survey_record_t));
+    return stats_pool_get(&g_survey_pool);
 }
 
 static inline void stats_survey_record_free(stats_survey_record_t *record)
 {
-    FREE(record);
+    stats_pool_put(&g_survey_pool, record);
 }
 
 int stats_mcs_nss_bw_to_dpp_index(int mcs, int nss, int bw)
@@ -162,6 +305,17 @@ int stats_mcs_nss_bw_to_dpp_index(int mcs, int nss, int bw)
         + bw * STATS_MSC_QTY * STATS_NSS_QTY;
 }
 
+/*
+ * Radio interface names do not change at runtime, so the phy_name to HAL
+ * radio index mapping is resolved once and then served from this table.
+ * It is hit for every survey channel that SM converts.
+ */
+static struct
+{
+    char                phy_name[128];
+    int                 radio_index;
+} g_radio_index_cache[RADIO_MAX_DEVICE_QTY];
+
 static bool radio_entry_to_hal_radio_index(radio_entry_t *radio_cfg, int *radioIndex)
 {
     INT ret;
@@ -169,6 +323,16 @@ static bool radio_entry_to_hal_radio_index(radio_entry_t *radio_cfg, int *radioI
     char radio_ifname[128];
     wifi_hal_capability_t cap;
 
+    for (r = 0; r < RADIO_MAX_DEVICE_QTY; r++)
+    {
+        if (g_radio_index_cache[r].phy_name[0] != '\0' &&
+            !strcmp(g_radio_index_cache[r].phy_name, radio_cfg->phy_name))
+        {
+            *radioIndex = g_radio_index_cache[r].radio_index;
+            return true;
+        }
+    }
+
     memset(&cap, 0, sizeof(cap));
 
     ret = wifi_getHalCapability(&cap);
@@ -201,6 +365,12 @@ static bool radio_entry_to_hal_radio_index(radio_entry_t *radio_cfg, int *radioI
         return false;
     }
 
+    if (*radioIndex < RADIO_MAX_DEVICE_QTY)
+    {
+        STRSCPY(g_radio_index_cache[*radioIndex].phy_name, radio_cfg->phy_name);
+        g_radio_index_cache[*radioIndex].radio_index = *radioIndex;
+    }
+
     return true;
 }
 
@@ -260,27 +430,55 @@ static int auto_rssi_to_above_noise_floor(int rssi)
 
 static void stats_client_record_free(stats_client_record_t *client_entry)
 {
-    FREE(client_entry);
+    stats_pool_put(&g_client_pool, client_entry);
 }
 
 static stats_client_record_t* stats_client_record_alloc()
 {
-    return CALLOC(1, sizeof(stats_client_record_t));
+    return stats_pool_get(&g_client_pool);
 }
 
+typedef enum
+{
+    STATS_CLIENT_PATH_BULK = 0,
+    STATS_CLIENT_PATH_PER_CLIENT,
+    STATS_CLIENT_PATH_QTY
+} stats_client_path_t;
+
+// Result of the per-client HAL call, filled in by stats_client_vap_fetch()
+typedef struct
+{
+    wifi_associated_dev_stats_t     stats;
+    ULLONG                          handle;
+    bool                            valid;
+} stats_client_hal_t;
+
+/*
+ * All HAL calls needed for one VAP. This is filled in without touching any
+ * state shared with the rest of this file, so it can run on a stats worker.
+ */
+typedef struct
+{
+    wifi_vap_info_t                *vap_info;
+    wifi_associated_dev3_t         *client_array;
+    UINT                            client_num;
+    stats_client_hal_t             *client_hal;     // per-client path only
+    stats_client_path_t             path;
+    bool                            valid;
+    uint64_t                        cost_us;
+} stats_vap_fetch_t;
+
 static bool stats_client_fetch(
         radio_entry_t              *radio_cfg,
         char                       *essid,
         ds_dlist_t                 *client_list,
-        int                         radioIndex,
-        int                         apIndex,
         char                       *apName,
-        wifi_associated_dev3_t     *assoc_dev)
+        wifi_associated_dev3_t     *assoc_dev,
+        stats_client_hal_t         *client_hal)
 {
     stats_client_record_t *client_entry = NULL;
-    mac_address_str_t mac_str;
-    ULLONG handle = 0;
-    int ret;
+
+    if (!client_hal->valid) goto err;
 
     client_entry = stats_client_record_alloc();
 
@@ -289,44 +487,491 @@ static bool stats_client_fetch(
     memcpy(&client_entry->info.mac, assoc_dev->cli_MACAddress, sizeof(client_entry->info.mac));
     STRLCPY(client_entry->info.ifname, apName);
     STRLCPY(client_entry->info.essid, essid);
-    dpp_mac_to_str(assoc_dev->cli_MACAddress, mac_str);
 
     // STATS
     memcpy(&client_entry->dev3, assoc_dev, sizeof(client_entry->dev3));
+    memcpy(&client_entry->stats, &client_hal->stats, sizeof(client_entry->stats));
+    client_entry->stats_cookie = client_hal->handle;
 
-    ret = wifi_getApAssociatedDeviceStats(
-            apIndex,
-            &assoc_dev->cli_MACAddress,
-            &client_entry->stats,
-            &handle);
-    if (ret != RETURN_OK) goto err;
-
-    client_entry->stats_cookie = handle;
-
-out:
     ds_dlist_insert_tail(client_list, client_entry);
     return true;
 
 err:
     LOG(WARNING, "%s: fetch error", __FUNCTION__);
-    stats_client_record_free(client_entry);
     return false;
 }
 
+#ifdef CONFIG_RDK_BULK_CLIENT_STATS
+/*
+ * Counters carried by wifi_associated_dev3_t. Vendors that do not fill them
+ * in report all zeros, in which case the caller falls back to the per-client
+ * wifi_getApAssociatedDeviceStats() path.
+ */
+static bool stats_client_dev3_has_counters(wifi_associated_dev3_t *assoc_dev)
+{
+    return assoc_dev->cli_BytesSent != 0
+        || assoc_dev->cli_BytesReceived != 0
+        || assoc_dev->cli_PacketsSent != 0
+        || assoc_dev->cli_PacketsReceived != 0;
+}
+
+static void stats_client_fetch_bulk(
+        radio_entry_t              *radio_cfg,
+        char                       *essid,
+        ds_dlist_t                 *client_list,
+        char                       *apName,
+        wifi_associated_dev3_t     *assoc_dev)
+{
+    stats_client_record_t *client_entry = NULL;
+    wifi_associated_dev_stats_t *stats;
+
+    client_entry = stats_client_record_alloc();
+
+    // INFO
+    client_entry->info.type = radio_cfg->type;
+    memcpy(&client_entry->info.mac, assoc_dev->cli_MACAddress, sizeof(client_entry->info.mac));
+    STRLCPY(client_entry->info.ifname, apName);
+    STRLCPY(client_entry->info.essid, essid);
+
+    // STATS
+    memcpy(&client_entry->dev3, assoc_dev, sizeof(client_entry->dev3));
+
+    stats = &client_entry->stats;
+    stats->cli_tx_bytes   = assoc_dev->cli_BytesSent;
+    stats->cli_rx_bytes   = assoc_dev->cli_BytesReceived;
+    stats->cli_tx_frames  = assoc_dev->cli_PacketsSent;
+    stats->cli_rx_frames  = assoc_dev->cli_PacketsReceived;
+    stats->cli_tx_retries = assoc_dev->cli_RetransCount;
+    stats->cli_tx_errors  = assoc_dev->cli_ErrorsSent;
+    // Not reported by DiagnosticResult3, kept at 0 so their deltas stay 0
+    stats->cli_rx_retries = 0;
+    stats->cli_rx_errors  = 0;
+    // Last data rates are reported in kbps
+    stats->cli_tx_rate    = (double)assoc_dev->cli_LastDataDownlinkRate / 1000.0;
+    stats->cli_rx_rate    = (double)assoc_dev->cli_LastDataUplinkRate / 1000.0;
+
+    // The association counter changes on every reconnect, which is all
+    // stats_clients_convert() needs from the cookie.
+    client_entry->stats_cookie = assoc_dev->cli_Associations;
+
+    ds_dlist_insert_tail(client_list, client_entry);
+}
+#endif /* CONFIG_RDK_BULK_CLIENT_STATS */
+
+/*
+ * Per-VAP cost of a client stats fetch (the client list call plus whatever
+ * per-client HAL calls follow), kept separately for the bulk and the
+ * per-client path so both can be compared on the same device.
+ */
+#define STATS_COST_VAP_MAX          (MAX_NUM_RADIOS * MAX_NUM_VAP_PER_RADIO)
+#define STATS_COST_BUCKETS          20      // log2(us), last bucket is >= ~0.5s
+#define STATS_COST_REPORT_ROUNDS    60
+
+static const char *g_client_path_name[STATS_CLIENT_PATH_QTY] =
+{
+    [STATS_CLIENT_PATH_BULK]       = "bulk",
+    [STATS_CLIENT_PATH_PER_CLIENT] = "per-client",
+};
+
+typedef struct
+{
+    uint32_t            hist[STATS_CLIENT_PATH_QTY][STATS_COST_BUCKETS];
+    uint64_t            total_us[STATS_CLIENT_PATH_QTY];
+    uint64_t            rounds[STATS_CLIENT_PATH_QTY];
+    uint64_t            clients[STATS_CLIENT_PATH_QTY];
+} stats_client_cost_t;
+
+static stats_client_cost_t  g_client_cost[STATS_COST_VAP_MAX];
+static uint32_t             g_client_cost_rounds;
+
+#ifdef CONFIG_RDK_BULK_CLIENT_STATS
+/*
+ * Client stats path of each VAP. The two paths use different cookies (the
+ * HAL stats handle vs. the association counter), so a VAP keeps the path it
+ * started with while it has clients; switching would look like a reconnect
+ * of every client. It is decided again once the VAP has no clients.
+ */
+static stats_client_path_t  g_client_path[STATS_COST_VAP_MAX];
+static bool                 g_client_path_pinned[STATS_COST_VAP_MAX];
+#endif
+
+static uint64_t stats_time_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static void stats_client_cost_add(
+        int                         apIndex,
+        stats_client_path_t         path,
+        uint32_t                    client_num,
+        uint64_t                    cost_us)
+{
+    stats_client_cost_t *cost;
+    int bucket = 0;
+
+    if (apIndex < 0 || apIndex >= STATS_COST_VAP_MAX) return;
+    cost = &g_client_cost[apIndex];
+
+    while (bucket < STATS_COST_BUCKETS - 1 && (cost_us >> (bucket + 1)) != 0)
+    {
+        bucket++;
+    }
+
+    cost->hist[path][bucket]++;
+    cost->total_us[path] += cost_us;
+    cost->rounds[path]++;
+    cost->clients[path] += client_num;
+}
+
+static void stats_client_cost_report(void)
+{
+    stats_client_cost_t *cost;
+    char hist[STATS_COST_BUCKETS * 12];
+    size_t len;
+    int vap;
+    int path;
+    int b;
+
+    if (++g_client_cost_rounds < STATS_COST_REPORT_ROUNDS) return;
+    g_client_cost_rounds = 0;
+
+    for (vap = 0; vap < STATS_COST_VAP_MAX; vap++)
+    {
+        cost = &g_client_cost[vap];
+        for (path = 0; path < STATS_CLIENT_PATH_QTY; path++)
+        {
+            if (cost->rounds[path] == 0) continue;
+
+            len = 0;
+            hist[0] = '\0';
+            for (b = 0; b < STATS_COST_BUCKETS && len < sizeof(hist); b++)
+            {
+                len += snprintf(hist + len, sizeof(hist) - len, "%s%u",
+                                b ? "," : "", cost->hist[path][b]);
+            }
+
+            LOGD("Stats client cost ap_index=%d path=%s rounds=%llu clients=%llu avg=%lluus log2us=[%s]",
+                 vap, g_client_path_name[path],
+                 (unsigned long long)cost->rounds[path],
+                 (unsigned long long)cost->clients[path],
+                 (unsigned long long)(cost->total_us[path] / cost->rounds[path]),
+                 hist);
+        }
+    }
+}
+
+
+static void stats_client_vap_fetch(stats_vap_fetch_t *job)
+{
+    wifi_vap_info_t *vap_info = job->vap_info;
+    stats_client_hal_t *client_hal;
+#ifdef CONFIG_RDK_BULK_CLIENT_STATS
+    bool *pinned;
+    int vap;
+#endif
+    uint64_t start_us;
+    int ret;
+    int i;
+
+    start_us = stats_time_us();
+
+    job->client_array = NULL;
+    job->client_num = 0;
+    job->client_hal = NULL;
+    job->path = STATS_CLIENT_PATH_PER_CLIENT;
+
+    ret = wifi_getApAssociatedDeviceDiagnosticResult3(vap_info->vap_index, &job->client_array, &job->client_num);
+    job->valid = (ret == RETURN_OK);
+    if (!job->valid) goto out;
+
+#ifdef CONFIG_RDK_BULK_CLIENT_STATS
+    vap = vap_info->vap_index;
+    pinned = (vap >= 0 && vap < STATS_COST_VAP_MAX) ? &g_client_path_pinned[vap] : NULL;
+
+    if (job->client_num == 0)
+    {
+        if (pinned != NULL) *pinned = false;
+        goto out;
+    }
+
+    if (pinned == NULL || !*pinned)
+    {
+        job->path = STATS_CLIENT_PATH_PER_CLIENT;
+        for (i = 0; i < (int)job->client_num; i++)
+        {
+            if (stats_client_dev3_has_counters(&job->client_array[i]))
+            {
+                job->path = STATS_CLIENT_PATH_BULK;
+                break;
+            }
+        }
+        if (pinned != NULL)
+        {
+            g_client_path[vap] = job->path;
+            *pinned = true;
+        }
+    }
+    else
+    {
+        job->path = g_client_path[vap];
+    }
+
+    if (job->path == STATS_CLIENT_PATH_BULK) goto out;
+#endif
+
+    if (job->client_num == 0) goto out;
+
+    job->client_hal = CALLOC(job->client_num, sizeof(*job->client_hal));
+    for (i = 0; i < (int)job->client_num; i++)
+    {
+        client_hal = &job->client_hal[i];
+        ret = wifi_getApAssociatedDeviceStats(
+                vap_info->vap_index,
+                &job->client_array[i].cli_MACAddress,
+                &client_hal->stats,
+                &client_hal->handle);
+        client_hal->valid = (ret == RETURN_OK);
+    }
+
+out:
+    job->cost_us = stats_time_us() - start_us;
+}
+
+/******************************************************************************
+ *  STATS WORKERS
+ *****************************************************************************/
+
+/*
+ * Optional pool of threads that run the per-VAP HAL fetches of a single
+ * stats_clients_get() call concurrently. Only the HAL calls are offloaded,
+ * records are built on the caller thread once all fetches are joined.
+ * SM requests client stats one radio at a time, so the VAPs of that radio
+ * are what can overlap; the per-radio times below show what each radio
+ * costs the sampling round.
+ */
+#ifndef CONFIG_RDK_STATS_WORKERS
+#define CONFIG_RDK_STATS_WORKERS    0
+#endif
+
+#define STATS_WORKERS_MAX           4
+
+static struct
+{
+    pthread_mutex_t                 lock;
+    pthread_cond_t                  work_cond;
+    pthread_cond_t                  done_cond;
+    pthread_t                       tid[STATS_WORKERS_MAX];
+    stats_vap_fetch_t              *jobs;
+    int                             jobs_num;
+    int                             jobs_next;
+    int                             jobs_done;
+    int                             workers;
+    bool                            started;
+    bool                            stop;
+} g_stats_workers =
+{
+    .lock       = PTHREAD_MUTEX_INITIALIZER,
+    .work_cond  = PTHREAD_COND_INITIALIZER,
+    .done_cond  = PTHREAD_COND_INITIALIZER,
+};
+
+/*
+ * Client stats fetch time per radio: wall clock on the caller thread and
+ * the sum of the per-VAP HAL calls, which exceeds the wall time when the
+ * VAPs were fetched in parallel
+ */
+typedef struct
+{
+    char                            phy_name[128];
+    uint64_t                        rounds;
+    uint64_t                        wall_us;
+    uint64_t                        hal_us;
+    uint64_t                        last_wall_us;
+    int                             vaps;
+} stats_radio_time_t;
+
+static stats_radio_time_t           g_radio_time[RADIO_MAX_DEVICE_QTY];
+static uint32_t                     g_radio_time_rounds;
+
+static void* stats_worker_main(void *arg)
+{
+    stats_vap_fetch_t *job;
+
+    pthread_mutex_lock(&g_stats_workers.lock);
+    for (;;)
+    {
+        while (!g_stats_workers.stop && g_stats_workers.jobs_next >= g_stats_workers.jobs_num)
+        {
+            pthread_cond_wait(&g_stats_workers.work_cond, &g_stats_workers.lock);
+        }
+
+        if (g_stats_workers.stop) break;
+
+        job = &g_stats_workers.jobs[g_stats_workers.jobs_next++];
+        pthread_mutex_unlock(&g_stats_workers.lock);
+
+        stats_client_vap_fetch(job);
+
+        pthread_mutex_lock(&g_stats_workers.lock);
+        if (++g_stats_workers.jobs_done == g_stats_workers.jobs_num)
+        {
+            pthread_cond_signal(&g_stats_workers.done_cond);
+        }
+    }
+    pthread_mutex_unlock(&g_stats_workers.lock);
+
+    return NULL;
+}
+
+static int stats_workers_start(void)
+{
+    int i;
+
+    if (g_stats_workers.started) return g_stats_workers.workers;
+    g_stats_workers.started = true;
+    g_stats_workers.stop = false;
+
+    for (i = 0; i < CONFIG_RDK_STATS_WORKERS && i < STATS_WORKERS_MAX; i++)
+    {
+        if (pthread_create(&g_stats_workers.tid[i], NULL, stats_worker_main, NULL) != 0)
+        {
+            LOGW("%s: failed to create stats worker %d: %s", __func__, i, strerror(errno));
+            break;
+        }
+        g_stats_workers.workers++;
+    }
+
+    LOGI("Stats: %d HAL worker(s) started", g_stats_workers.workers);
+    return g_stats_workers.workers;
+}
+
+/*
+ * Called from target_close(). Fetches are always joined before
+ * stats_clients_get() returns, so workers are idle here.
+ */
+static void stats_workers_stop(void)
+{
+    int i;
+
+    if (!g_stats_workers.started) return;
+
+    pthread_mutex_lock(&g_stats_workers.lock);
+    g_stats_workers.stop = true;
+    pthread_cond_broadcast(&g_stats_workers.work_cond);
+    pthread_mutex_unlock(&g_stats_workers.lock);
+
+    for (i = 0; i < g_stats_workers.workers; i++)
+    {
+        pthread_join(g_stats_workers.tid[i], NULL);
+    }
+
+    LOGI("Stats: %d HAL worker(s) stopped", g_stats_workers.workers);
+    g_stats_workers.workers = 0;
+    g_stats_workers.started = false;
+}
+
+static void stats_client_vap_fetch_all(stats_vap_fetch_t *jobs, int jobs_num)
+{
+    int i;
+
+    if (jobs_num > 1 && CONFIG_RDK_STATS_WORKERS > 0 && stats_workers_start() > 0)
+    {
+        pthread_mutex_lock(&g_stats_workers.lock);
+        g_stats_workers.jobs = jobs;
+        g_stats_workers.jobs_num = jobs_num;
+        g_stats_workers.jobs_next = 0;
+        g_stats_workers.jobs_done = 0;
+        pthread_cond_broadcast(&g_stats_workers.work_cond);
+
+        while (g_stats_workers.jobs_done < jobs_num)
+        {
+            pthread_cond_wait(&g_stats_workers.done_cond, &g_stats_workers.lock);
+        }
+
+        g_stats_workers.jobs = NULL;
+        g_stats_workers.jobs_num = 0;
+        g_stats_workers.jobs_next = 0;
+        pthread_mutex_unlock(&g_stats_workers.lock);
+        return;
+    }
+
+    for (i = 0; i < jobs_num; i++)
+    {
+        stats_client_vap_fetch(&jobs[i]);
+    }
+}
+
+static void stats_radio_time_add(
+        int                         radio_index,
+        const char                 *phy_name,
+        int                         vaps,
+        uint64_t                    wall_us,
+        uint64_t                    hal_us)
+{
+    stats_radio_time_t *t;
+
+    if (radio_index < 0 || radio_index >= RADIO_MAX_DEVICE_QTY) return;
+    t = &g_radio_time[radio_index];
+
+    STRSCPY(t->phy_name, phy_name);
+    t->rounds++;
+    t->wall_us += wall_us;
+    t->hal_us += hal_us;
+    t->last_wall_us = wall_us;
+    t->vaps = vaps;
+}
+
+/*
+ * Per-radio averages plus the sum of the latest per-radio wall times, which
+ * is what one client sampling round over all radios costs SM
+ */
+static void stats_radio_time_report(void)
+{
+    stats_radio_time_t *t;
+    uint64_t round_us = 0;
+    int r;
+
+    if (++g_radio_time_rounds < STATS_COST_REPORT_ROUNDS) return;
+    g_radio_time_rounds = 0;
+
+    for (r = 0; r < RADIO_MAX_DEVICE_QTY; r++)
+    {
+        t = &g_radio_time[r];
+        if (t->rounds == 0) continue;
+
+        LOGD("Stats client fetch radio=%s vaps=%d rounds=%llu avg wall=%lluus avg hal=%lluus last wall=%lluus",
+             t->phy_name, t->vaps,
+             (unsigned long long)t->rounds,
+             (unsigned long long)(t->wall_us / t->rounds),
+             (unsigned long long)(t->hal_us / t->rounds),
+             (unsigned long long)t->last_wall_us);
+        round_us += t->last_wall_us;
+    }
+
+    LOGD("Stats client fetch all radios: wall=%lluus workers=%d",
+         (unsigned long long)round_us, g_stats_workers.workers);
+}
 
 bool stats_clients_get(
         radio_entry_t              *radio_cfg,
         radio_essid_t              *essid,
         ds_dlist_t                 *client_list)
 {
-    wifi_associated_dev3_t *client_array;
-    UINT client_num;
-    int ret;
+    stats_vap_fetch_t jobs[MAX_NUM_VAP_PER_RADIO];
+    stats_vap_fetch_t *job;
+    int jobs_num = 0;
     int i;
+    int j;
     INT radio_index;
     ULONG s;
     wifi_vap_info_map_t map;
     wifi_vap_info_t *vap_info;
+    uint64_t start_us;
+    uint64_t wall_us;
+    uint64_t hal_us = 0;
 
     memset(&map, 0, sizeof(wifi_vap_info_map_t));
 
@@ -342,7 +987,7 @@ bool stats_clients_get(
         return false;
     }
 
-    for (s = 0; s < map.num_vaps; s++)
+    for (s = 0; s < map.num_vaps && jobs_num < (int)ARRAY_SIZE(jobs); s++)
     {
         vap_info = &map.vap_array[s];
         if (vap_info->u.bss_info.enabled == false)
@@ -363,10 +1008,22 @@ bool stats_clients_get(
            continue;
         }
 
-        client_array = NULL;
-        client_num = 0;
-        ret = wifi_getApAssociatedDeviceDiagnosticResult3(vap_info->vap_index, &client_array, &client_num);
-        if (ret != RETURN_OK)
+        memset(&jobs[jobs_num], 0, sizeof(jobs[jobs_num]));
+        jobs[jobs_num].vap_info = vap_info;
+        jobs_num++;
+    }
+
+    start_us = stats_time_us();
+    stats_client_vap_fetch_all(jobs, jobs_num);
+    wall_us = stats_time_us() - start_us;
+
+    for (j = 0; j < jobs_num; j++)
+    {
+        job = &jobs[j];
+        vap_info = job->vap_info;
+        hal_us += job->cost_us;
+
+        if (!job->valid)
         {
             LOGW("%s %s %u %s: fetch client list",
                  radio_cfg->phy_name, vap_info->vap_name, vap_info->vap_index, vap_info->u.bss_info.ssid);
@@ -374,18 +1031,39 @@ bool stats_clients_get(
         }
 
         LOGT("%s %s %u %s: fetch client list: %d clients",
-             radio_cfg->phy_name, vap_info->vap_name, vap_info->vap_index, vap_info->u.bss_info.ssid, client_num);
+             radio_cfg->phy_name, vap_info->vap_name, vap_info->vap_index, vap_info->u.bss_info.ssid, job->client_num);
 
-        for (i = 0; i < (int)client_num; i++)
+        for (i = 0; i < (int)job->client_num; i++)
         {
+#ifdef CONFIG_RDK_BULK_CLIENT_STATS
+            if (job->path == STATS_CLIENT_PATH_BULK)
+            {
+                stats_client_fetch_bulk(
+                        radio_cfg, vap_info->u.bss_info.ssid, client_list,
+                        vap_info->vap_name, &job->client_array[i]);
+                continue;
+            }
+#endif
             stats_client_fetch(
                     radio_cfg, vap_info->u.bss_info.ssid, client_list,
-                    radio_index, vap_info->vap_index, vap_info->vap_name, &client_array[i]);
+                    vap_info->vap_name, &job->client_array[i], &job->client_hal[i]);
         }
 
-        free(client_array);
+        FREE(job->client_hal);
+        free(job->client_array);
+
+        stats_client_cost_add(vap_info->vap_index, job->path, job->client_num, job->cost_us);
     }
 
+    LOGT("%s: client stats fetched from %d VAP(s): wall=%lluus hal=%lluus workers=%d",
+         radio_cfg->phy_name, jobs_num,
+         (unsigned long long)wall_us, (unsigned long long)hal_us,
+         g_stats_workers.workers);
+
+    stats_radio_time_add(radio_index, radio_cfg->phy_name, jobs_num, wall_us, hal_us);
+    stats_radio_time_report();
+    stats_client_cost_report();
+
     return true;
 }
 
@@ -483,6 +1161,204 @@ bool stats_clients_convert(
  *  SURVEY
  *****************************************************************************/
 
+/*
+ * Recent survey samples per radio, scan type and channel. Every column
+ * (active, busy, ...) is its own array indexed by ring position and all
+ * columns of a sample share a single timestamp. Columns hold running totals:
+ * cumulative HAL counters are stored as they are, one-shot counters are
+ * accumulated on push. The totals over the window between any two samples
+ * still in the ring are then one subtraction per column, however far apart
+ * the samples are.
+ */
+#define PERCENT(v1, v2) (v2 > 0 ? (v1*100/v2) : 0)
+
+#define STATS_SURVEY_HIST_DEPTH     8
+#define STATS_SURVEY_CHAN_ID_MAX    256
+
+typedef enum
+{
+    STATS_SURVEY_COL_ACTIVE = 0,
+    STATS_SURVEY_COL_BUSY,
+    STATS_SURVEY_COL_BUSY_EXT,
+    STATS_SURVEY_COL_TX,
+    STATS_SURVEY_COL_RX,
+    STATS_SURVEY_COL_SELF,
+    STATS_SURVEY_COL_QTY
+} stats_survey_col_t;
+
+typedef struct
+{
+    uint32_t            chan;
+    uint32_t            seq;        // sequence number of the newest sample, 0 if none
+    uint32_t            count;
+    uint64_t            ts_ms[STATS_SURVEY_HIST_DEPTH];
+    uint64_t            col[STATS_SURVEY_COL_QTY][STATS_SURVEY_HIST_DEPTH];
+} stats_survey_hist_t;
+
+typedef struct
+{
+    uint8_t             slot_of[STATS_SURVEY_CHAN_ID_MAX];  // slot + 1, 0 if none
+    uint32_t            slot_num;
+    stats_survey_hist_t *slot[STATS_SURVEY_CHAN_MAX];
+} stats_survey_ring_t;
+
+static stats_survey_ring_t g_survey_ring[RADIO_MAX_DEVICE_QTY][RADIO_SCAN_MAX_TYPE_QTY];
+
+static bool stats_survey_cumulative(radio_scan_type_t scan_type)
+{
+    if (scan_type == RADIO_SCAN_TYPE_ONCHAN)
+    {
+        return CONFIG_RDK_CUMULATIVE_SURVEY_ONCHAN;
+    }
+    return CONFIG_RDK_CUMULATIVE_SURVEY_OFFCHAN;
+}
+
+static stats_survey_hist_t* stats_survey_hist_get(
+        int                         radio_index,
+        radio_scan_type_t           scan_type,
+        uint32_t                    chan,
+        bool                        create)
+{
+    stats_survey_ring_t *ring;
+    stats_survey_hist_t *hist;
+    int scan_index;
+
+    scan_index = radio_get_scan_index_from_type(scan_type);
+    if (radio_index < 0 || radio_index >= RADIO_MAX_DEVICE_QTY) return NULL;
+    if (scan_index < 0 || scan_index >= RADIO_SCAN_MAX_TYPE_QTY) return NULL;
+    if (chan >= STATS_SURVEY_CHAN_ID_MAX) return NULL;
+
+    ring = &g_survey_ring[radio_index][scan_index];
+    if (ring->slot_of[chan] != 0)
+    {
+        return ring->slot[ring->slot_of[chan] - 1];
+    }
+
+    if (!create || ring->slot_num >= STATS_SURVEY_CHAN_MAX) return NULL;
+
+    hist = CALLOC(1, sizeof(*hist));
+    hist->chan = chan;
+    ring->slot[ring->slot_num++] = hist;
+    ring->slot_of[chan] = ring->slot_num;
+
+    return hist;
+}
+
+/*
+ * Store a fetched sample and return its sequence number, which the survey
+ * record keeps to find the sample again on conversion. 0 if the ring has no
+ * room for the channel.
+ */
+static uint32_t stats_survey_hist_push(
+        int                         radio_index,
+        radio_scan_type_t           scan_type,
+        uint64_t                    timestamp_ms,
+        wifi_channelStats_t        *chan_stats)
+{
+    stats_survey_hist_t *hist;
+    uint64_t sample[STATS_SURVEY_COL_QTY];
+    bool cumulative;
+    uint32_t prev;
+    uint32_t pos;
+    int c;
+
+    hist = stats_survey_hist_get(radio_index, scan_type, chan_stats->ch_number, true);
+    if (hist == NULL) return 0;
+
+    sample[STATS_SURVEY_COL_ACTIVE]   = chan_stats->ch_utilization_total;
+    sample[STATS_SURVEY_COL_BUSY]     = chan_stats->ch_utilization_busy;
+    sample[STATS_SURVEY_COL_BUSY_EXT] = chan_stats->ch_utilization_busy_ext;
+    sample[STATS_SURVEY_COL_TX]       = chan_stats->ch_utilization_busy_tx;
+    sample[STATS_SURVEY_COL_RX]       = chan_stats->ch_utilization_busy_rx;
+    sample[STATS_SURVEY_COL_SELF]     = chan_stats->ch_utilization_busy_self;
+
+    cumulative = stats_survey_cumulative(scan_type);
+    prev = hist->seq % STATS_SURVEY_HIST_DEPTH;
+
+    // 0 marks records without a ring sample, start over at 1 on wrap
+    if (++hist->seq == 0)
+    {
+        hist->seq = 1;
+        hist->count = 0;
+    }
+    pos = hist->seq % STATS_SURVEY_HIST_DEPTH;
+
+    for (c = 0; c < STATS_SURVEY_COL_QTY; c++)
+    {
+        if (!cumulative && hist->count > 0)
+        {
+            sample[c] += hist->col[c][prev];
+        }
+        hist->col[c][pos] = sample[c];
+    }
+
+    hist->ts_ms[pos] = timestamp_ms;
+    if (hist->count < STATS_SURVEY_HIST_DEPTH) hist->count++;
+
+    return hist->seq;
+}
+
+static bool stats_survey_hist_holds(stats_survey_hist_t *hist, uint32_t seq)
+{
+    return seq != 0 && seq <= hist->seq && hist->seq - seq < hist->count;
+}
+
+/*
+ * Column totals over the window (seq_old, seq_new]. Fails if either sample
+ * already left the ring, the caller then falls back to the records.
+ */
+static bool stats_survey_hist_delta(
+        int                         radio_index,
+        radio_scan_type_t           scan_type,
+        uint32_t                    chan,
+        uint32_t                    seq_old,
+        uint32_t                    seq_new,
+        uint64_t                   *delta)
+{
+    stats_survey_hist_t *hist;
+    uint32_t pos_old;
+    uint32_t pos_new;
+    int c;
+
+    if (seq_old >= seq_new) return false;
+
+    hist = stats_survey_hist_get(radio_index, scan_type, chan, false);
+    if (hist == NULL) return false;
+
+    if (!stats_survey_hist_holds(hist, seq_old)) return false;
+    if (!stats_survey_hist_holds(hist, seq_new)) return false;
+
+    pos_old = seq_old % STATS_SURVEY_HIST_DEPTH;
+    pos_new = seq_new % STATS_SURVEY_HIST_DEPTH;
+    for (c = 0; c < STATS_SURVEY_COL_QTY; c++)
+    {
+        delta[c] = hist->col[c][pos_new] - hist->col[c][pos_old];
+    }
+
+    return true;
+}
+
+static void stats_survey_ring_cleanup(void)
+{
+    stats_survey_ring_t *ring;
+    uint32_t i;
+    int r;
+    int s;
+
+    for (r = 0; r < RADIO_MAX_DEVICE_QTY; r++)
+    {
+        for (s = 0; s < RADIO_SCAN_MAX_TYPE_QTY; s++)
+        {
+            ring = &g_survey_ring[r][s];
+            for (i = 0; i < ring->slot_num; i++)
+            {
+                FREE(ring->slot[i]);
+            }
+            memset(ring, 0, sizeof(*ring));
+        }
+    }
+}
+
 bool stats_survey_get(
         radio_entry_t              *radio_cfg,
         uint32_t                   *chan_list,
@@ -494,6 +1370,7 @@ bool stats_survey_get(
     int ret;
     int radioIndex = 0;
     stats_survey_record_t *survey_record;
+    uint32_t hist_seq;
 
     // phy_name
     if (!radio_entry_to_hal_radio_index(radio_cfg, &radioIndex))
@@ -501,6 +1378,13 @@ bool stats_survey_get(
         return false;
     }
 
+    if (chan_num > STATS_SURVEY_CHAN_MAX)
+    {
+        LOGW("%s: survey limited to %d of %u channels", radio_cfg->phy_name,
+             STATS_SURVEY_CHAN_MAX, chan_num);
+        chan_num = STATS_SURVEY_CHAN_MAX;
+    }
+
     // Mark requested channels
     survey_data_t survey_data;
     memset(&survey_data, 0, sizeof(survey_data));
@@ -519,12 +1403,17 @@ bool stats_survey_get(
     // Assume that all were collected and stored into the array
     for (i = 0; i < (int)survey_data.num_chan; i++)
     {
+        hist_seq = stats_survey_hist_push(radioIndex, scan_type,
+                                          survey_data.timestamp_ms, &survey_data.chan[i]);
+
         survey_record = stats_survey_record_alloc();
+        survey_record->radio_index = radioIndex;
+        survey_record->hist_seq = hist_seq;
 
         if (scan_type == RADIO_SCAN_TYPE_ONCHAN)
         {
             survey_record->info.chan = chan_list[i];
-            survey_record->info.timestamp_ms = get_timestamp();
+            survey_record->info.timestamp_ms = survey_data.timestamp_ms;
 
             survey_record->stats.survey_bss.chan_active   = survey_data.chan[i].ch_utilization_total;
             survey_record->stats.survey_bss.chan_busy     = survey_data.chan[i].ch_utilization_busy;
@@ -550,7 +1439,7 @@ bool stats_survey_get(
         else
         {
             survey_record->info.chan = chan_list[i];
-            survey_record->info.timestamp_ms = get_timestamp();
+            survey_record->info.timestamp_ms = survey_data.timestamp_ms;
 
             survey_record->stats.survey_obss.chan_active   = (uint32_t)survey_data.chan[i].ch_utilization_total;
             survey_record->stats.survey_obss.chan_busy     = (uint32_t)survey_data.chan[i].ch_utilization_busy;
@@ -588,6 +1477,8 @@ bool stats_survey_convert(
         dpp_survey_record_t        *survey_record)
 {
     radio_type_t                    radio_type;
+    uint64_t                        delta[STATS_SURVEY_COL_QTY];
+    bool                            from_ring = false;
 
     if ((!data_new) || (!data_old) || (!survey_record))
     {
@@ -595,7 +1486,20 @@ bool stats_survey_convert(
     }
     radio_type = radio_cfg->type;
 
-#define PERCENT(v1, v2) (v2 > 0 ? (v1*100/v2) : 0)
+    /*
+     * The totals over the window between the two samples come from the
+     * survey ring. The record values are only used once a sample left it.
+     */
+    if (data_new->radio_index == data_old->radio_index)
+    {
+        from_ring = stats_survey_hist_delta(
+                data_new->radio_index,
+                scan_type,
+                data_new->info.chan,
+                data_old->hist_seq,
+                data_new->hist_seq,
+                delta);
+    }
 
 #define DELTA_TYPE(TYPE, NEW, OLD) (CONFIG_RDK_CUMULATIVE_##TYPE ? (NEW - OLD) : NEW)
 #define XDELTA_TYPE(TYPE, F) DELTA_TYPE(TYPE, data_new->stats.F, data_old->stats.F)
@@ -603,16 +1507,30 @@ bool stats_survey_convert(
 #define XDELTA_ONCHAN(F)  XDELTA_TYPE(SURVEY_ONCHAN, F)
 #define XDELTA_OFFCHAN(F) XDELTA_TYPE(SURVEY_OFFCHAN, F)
 
+#define RDELTA(C) delta[STATS_SURVEY_COL_##C]
+
     if (scan_type == RADIO_SCAN_TYPE_ONCHAN)
     {
         stats_survey_bss_t     data;
 
-        data.chan_active    = XDELTA_ONCHAN(survey_bss.chan_active);
-        data.chan_tx        = XDELTA_ONCHAN(survey_bss.chan_tx);
-        data.chan_rx        = XDELTA_ONCHAN(survey_bss.chan_rx);
-        data.chan_busy      = XDELTA_ONCHAN(survey_bss.chan_busy);
-        data.chan_busy_ext  = XDELTA_ONCHAN(survey_bss.chan_busy_ext);
-        data.chan_self      = XDELTA_ONCHAN(survey_bss.chan_self);
+        if (from_ring)
+        {
+            data.chan_active    = RDELTA(ACTIVE);
+            data.chan_tx        = RDELTA(TX);
+            data.chan_rx        = RDELTA(RX);
+            data.chan_busy      = RDELTA(BUSY);
+            data.chan_busy_ext  = RDELTA(BUSY_EXT);
+            data.chan_self      = RDELTA(SELF);
+        }
+        else
+        {
+            data.chan_active    = XDELTA_ONCHAN(survey_bss.chan_active);
+            data.chan_tx        = XDELTA_ONCHAN(survey_bss.chan_tx);
+            data.chan_rx        = XDELTA_ONCHAN(survey_bss.chan_rx);
+            data.chan_busy      = XDELTA_ONCHAN(survey_bss.chan_busy);
+            data.chan_busy_ext  = XDELTA_ONCHAN(survey_bss.chan_busy_ext);
+            data.chan_self      = XDELTA_ONCHAN(survey_bss.chan_self);
+        }
 
         LOG(TRACE,
             "Processed %s %s survey delta "
@@ -641,12 +1559,24 @@ bool stats_survey_convert(
     {
         stats_survey_obss_t     data;
 
-        data.chan_active    = XDELTA_OFFCHAN(survey_obss.chan_active);
-        data.chan_tx        = XDELTA_OFFCHAN(survey_obss.chan_tx);
-        data.chan_rx        = XDELTA_OFFCHAN(survey_obss.chan_rx);
-        data.chan_busy      = XDELTA_OFFCHAN(survey_obss.chan_busy);
-        data.chan_busy_ext  = XDELTA_OFFCHAN(survey_obss.chan_busy_ext);
-        data.chan_self      = XDELTA_OFFCHAN(survey_obss.chan_self);
+        if (from_ring)
+        {
+            data.chan_active    = (uint32_t)RDELTA(ACTIVE);
+            data.chan_tx        = (uint32_t)RDELTA(TX);
+            data.chan_rx        = (uint32_t)RDELTA(RX);
+            data.chan_busy      = (uint32_t)RDELTA(BUSY);
+            data.chan_busy_ext  = (uint32_t)RDELTA(BUSY_EXT);
+            data.chan_self      = (uint32_t)RDELTA(SELF);
+        }
+        else
+        {
+            data.chan_active    = XDELTA_OFFCHAN(survey_obss.chan_active);
+            data.chan_tx        = XDELTA_OFFCHAN(survey_obss.chan_tx);
+            data.chan_rx        = XDELTA_OFFCHAN(survey_obss.chan_rx);
+            data.chan_busy      = XDELTA_OFFCHAN(survey_obss.chan_busy);
+            data.chan_busy_ext  = XDELTA_OFFCHAN(survey_obss.chan_busy_ext);
+            data.chan_self      = XDELTA_OFFCHAN(survey_obss.chan_self);
+        }
 
         LOG(TRACE,
             "Processed %s %s survey delta "
@@ -1147,6 +2077,226 @@ bool stats_scan_get(
     return true;
 }
 
+/******************************************************************************
+ *  CAPACITY
+ *****************************************************************************/
+
+/*
+ * Capacity is sampled in the background at a high rate from counters the HAL
+ * already exposes: on-channel active/busy_tx time from the channel stats and
+ * tx bytes from the radio traffic stats. Each sample goes into a fixed size
+ * ring and is accumulated into the cumulative capacity record SM reads
+ * (chan_active, chan_tx, bytes_tx); the obsolete samples and queue[] fields
+ * are left zero. The sampler starts on the first capacity request and stops again when
+ * nobody asked for capacity for a while.
+ */
+#define STATS_CAPACITY_INTERVAL         0.5     // seconds
+#define STATS_CAPACITY_RING_DEPTH       64
+#define STATS_CAPACITY_CHAN_ROUNDS      20      // re-read operating channel every N samples
+#define STATS_CAPACITY_IDLE_ROUNDS      240     // stop after N samples without a request
+
+typedef struct
+{
+    int                     radio_index;
+    bool                    running;
+    ev_timer                timer;
+    ULONG                   channel;
+    uint32_t                rounds;
+    uint32_t                idle_rounds;
+
+    // Raw counters of the previous sample
+    bool                    prev_valid;
+    uint64_t                prev_active;
+    uint64_t                prev_tx;
+    uint64_t                prev_bytes;
+
+    // Per-sample deltas, one column per counter
+    uint32_t                head;
+    uint32_t                count;
+    uint64_t                ring_active[STATS_CAPACITY_RING_DEPTH];
+    uint64_t                ring_tx[STATS_CAPACITY_RING_DEPTH];
+    uint64_t                ring_bytes[STATS_CAPACITY_RING_DEPTH];
+
+    // Running sums over the ring, and the number of samples taken
+    uint64_t                win_active;
+    uint64_t                win_tx;
+    uint64_t                win_bytes;
+    uint64_t                samples;
+
+    // Cumulative data handed out by stats_capacity_get()
+    stats_capacity_data_t   total;
+} stats_capacity_sampler_t;
+
+static const stats_capacity_hal_ops_t g_capacity_hal_ops_default =
+{
+    .channel_get        = wifi_getRadioChannel,
+    .channel_stats_get  = wifi_getRadioChannelStats,
+    .traffic_stats_get  = wifi_getRadioTrafficStats2,
+};
+
+static const stats_capacity_hal_ops_t  *g_capacity_hal_ops = &g_capacity_hal_ops_default;
+static stats_capacity_sampler_t         g_capacity_sampler[RADIO_MAX_DEVICE_QTY];
+
+void stats_capacity_hal_ops_set(const stats_capacity_hal_ops_t *ops)
+{
+    g_capacity_hal_ops = ops ? ops : &g_capacity_hal_ops_default;
+}
+
+static uint64_t stats_capacity_counter_delta(uint64_t cur, uint64_t prev, bool cumulative)
+{
+    if (!cumulative) return cur;
+    // Counter reset (e.g. channel change or driver restart)
+    if (cur < prev) return 0;
+    return cur - prev;
+}
+
+static void stats_capacity_sample(stats_capacity_sampler_t *sampler)
+{
+    const bool cumulative = CONFIG_RDK_CUMULATIVE_SURVEY_ONCHAN;
+    wifi_radioTrafficStats2_t traffic;
+    wifi_channelStats_t chan_stats;
+    uint64_t d_active;
+    uint64_t d_tx;
+    uint64_t d_bytes;
+    uint32_t pos;
+
+    if (sampler->channel == 0 || (sampler->rounds % STATS_CAPACITY_CHAN_ROUNDS) == 0)
+    {
+        if (g_capacity_hal_ops->channel_get(sampler->radio_index, &sampler->channel) != RETURN_OK)
+        {
+            LOGD("%s: radio %d: failed to get channel", __func__, sampler->radio_index);
+            return;
+        }
+    }
+    sampler->rounds++;
+
+    memset(&chan_stats, 0, sizeof(chan_stats));
+    chan_stats.ch_number = sampler->channel;
+    chan_stats.ch_in_pool = true;
+    if (g_capacity_hal_ops->channel_stats_get(sampler->radio_index, &chan_stats, 1) != RETURN_OK)
+    {
+        return;
+    }
+
+    memset(&traffic, 0, sizeof(traffic));
+    if (g_capacity_hal_ops->traffic_stats_get(sampler->radio_index, &traffic) != RETURN_OK)
+    {
+        return;
+    }
+
+    if (!sampler->prev_valid)
+    {
+        sampler->prev_valid = true;
+        sampler->prev_active = chan_stats.ch_utilization_total;
+        sampler->prev_tx = chan_stats.ch_utilization_busy_tx;
+        sampler->prev_bytes = traffic.radio_BytesSent;
+        if (cumulative) return;
+    }
+
+    d_active = stats_capacity_counter_delta(chan_stats.ch_utilization_total, sampler->prev_active, cumulative);
+    d_tx = stats_capacity_counter_delta(chan_stats.ch_utilization_busy_tx, sampler->prev_tx, cumulative);
+    d_bytes = stats_capacity_counter_delta(traffic.radio_BytesSent, sampler->prev_bytes, true);
+
+    sampler->prev_active = chan_stats.ch_utilization_total;
+    sampler->prev_tx = chan_stats.ch_utilization_busy_tx;
+    sampler->prev_bytes = traffic.radio_BytesSent;
+
+    if (d_active == 0) return;
+    if (d_tx > d_active) d_tx = d_active;
+
+    pos = (sampler->count == 0) ? 0 : (sampler->head + 1) % STATS_CAPACITY_RING_DEPTH;
+    if (sampler->count == STATS_CAPACITY_RING_DEPTH)
+    {
+        sampler->win_active -= sampler->ring_active[pos];
+        sampler->win_tx -= sampler->ring_tx[pos];
+        sampler->win_bytes -= sampler->ring_bytes[pos];
+    }
+    sampler->ring_active[pos] = d_active;
+    sampler->ring_tx[pos] = d_tx;
+    sampler->ring_bytes[pos] = d_bytes;
+    sampler->head = pos;
+    if (sampler->count < STATS_CAPACITY_RING_DEPTH) sampler->count++;
+
+    sampler->win_active += d_active;
+    sampler->win_tx += d_tx;
+    sampler->win_bytes += d_bytes;
+    sampler->samples++;
+
+    sampler->total.chan_active += d_active;
+    sampler->total.chan_tx += d_tx;
+    sampler->total.bytes_tx += d_bytes;
+}
+
+static void stats_capacity_timer_cb(EV_P_ ev_timer *w, int revents)
+{
+    stats_capacity_sampler_t *sampler = w->data;
+
+    if (++sampler->idle_rounds > STATS_CAPACITY_IDLE_ROUNDS)
+    {
+        LOGI("Capacity sampler for radio %d stopped (idle)", sampler->radio_index);
+        ev_timer_stop(EV_A_ w);
+        sampler->running = false;
+        sampler->prev_valid = false;
+        return;
+    }
+
+    stats_capacity_sample(sampler);
+}
+
+static void stats_capacity_window_log(stats_capacity_sampler_t *sampler)
+{
+    LOGT("Capacity radio %d: last %u samples busy_tx=%llu%% bytes_tx=%llu (total samples=%llu)",
+         sampler->radio_index, sampler->count,
+         (unsigned long long)PERCENT(sampler->win_tx, sampler->win_active),
+         (unsigned long long)sampler->win_bytes,
+         (unsigned long long)sampler->samples);
+}
+
+bool stats_capacity_get(
+        radio_entry_t              *radio_cfg,
+        stats_capacity_data_t      *capacity_result)
+{
+    stats_capacity_sampler_t *sampler;
+    int radio_index;
+
+    if (!radio_entry_to_hal_radio_index(radio_cfg, &radio_index))
+    {
+        return false;
+    }
+
+    if (radio_index < 0 || radio_index >= RADIO_MAX_DEVICE_QTY)
+    {
+        return false;
+    }
+
+    sampler = &g_capacity_sampler[radio_index];
+    sampler->idle_rounds = 0;
+
+    if (!sampler->running)
+    {
+        sampler->radio_index = radio_index;
+        sampler->channel = 0;
+        sampler->rounds = 0;
+        sampler->running = true;
+
+        ev_timer_init(&sampler->timer, stats_capacity_timer_cb,
+                      STATS_CAPACITY_INTERVAL, STATS_CAPACITY_INTERVAL);
+        sampler->timer.data = sampler;
+        ev_timer_start(EV_DEFAULT, &sampler->timer);
+
+        LOGI("Capacity sampler for %s (radio %d) started", radio_cfg->phy_name, radio_index);
+
+        // Take a baseline right away so the first interval is not lost
+        stats_capacity_sample(sampler);
+    }
+
+    stats_capacity_window_log(sampler);
+
+    memcpy(capacity_result, &sampler->total, sizeof(*capacity_result));
+
+    return true;
+}
+
 static
 radio_entry_t* target_radio_scan_config_map(
         radio_entry_t              *radio_cfg,
@@ -1282,6 +2432,8 @@ bool target_stats_clients_get(
 {
     bool status = true;
 
+    stats_pool_trim(&g_client_pool);
+
     radio_entry_t *radio_cfg_ctx = target_radio_config_map(radio_cfg);
     if (radio_cfg_ctx == NULL)
     {
@@ -1297,6 +2449,8 @@ bool target_stats_clients_get(
         status = false;
     }
 
+    stats_pool_report(&g_client_pool);
+
 exit:
     return (*client_cb)(client_list, client_ctx, status);
 }
@@ -1348,6 +2502,8 @@ bool target_stats_survey_get(
     bool ret;
     bool status = true;
 
+    stats_pool_trim(&g_survey_pool);
+
     radio_cfg_ctx = target_radio_scan_config_map(radio_cfg, scan_type);
     if (radio_cfg_ctx == NULL)
     {
@@ -1366,6 +2522,8 @@ bool target_stats_survey_get(
         status = false;
     }
 
+    stats_pool_report(&g_survey_pool);
+
 exit:
     return (*survey_cb)(survey_list, survey_ctx, status);
 }
@@ -1480,6 +2638,21 @@ bool target_stats_capacity_get(
         radio_entry_t              *radio_cfg,
         target_capacity_data_t     *capacity_new)
 {
-    // Not used
-    return false;
+    radio_entry_t *radio_cfg_ctx = NULL;
+
+    radio_cfg_ctx = target_radio_config_map(radio_cfg);
+    if (radio_cfg_ctx == NULL)
+    {
+        return false;
+    }
+
+    return stats_capacity_get(radio_cfg_ctx, capacity_new);
+}
+
+void stats_cleanup(void)
+{
+    stats_workers_stop();
+    stats_survey_ring_cleanup();
+    stats_pool_flush(&g_client_pool);
+    stats_pool_flush(&g_survey_pool);
 }
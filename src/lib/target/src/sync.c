@@ -59,7 +59,24 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define MODULE_ID               LOG_MODULE_ID_HAL
 
-#define SYNC_RETRY      3
+// Reconnect backoff, in seconds
+#define SYNC_RETRY_MIN          0.5
+#define SYNC_RETRY_MAX          30.0
+#define SYNC_RETRY_JITTER       0.25    // +/- fraction of the delay
+#define SYNC_RETRY_STABLE       10.0    // connection lifetime which resets the backoff
+
+// Mesh agent messages are fixed-size MeshSync frames on a stream socket
+#define SYNC_RX_BUF_MSGS        8
+#define SYNC_RX_READS_MAX       16  // recv() calls per wakeup
+#define SYNC_TX_QUEUE_MAX       64
+
+// State resync requested by mesh agent messages
+#define SYNC_RESYNC_DEBOUNCE    0.5     // seconds without new requests
+#define SYNC_RESYNC_MAX_DELAY   3.0     // seconds since the first request
+#define SYNC_RESYNC_VAP_MAX     64
+
+// Latest state messages, replayed on every connect
+#define SYNC_STATE_MAX          64
 
 /*****************************************************************************/
 
@@ -104,7 +121,79 @@ static ev_io                sync_evio;
 static bool                 sync_initialized = false;
 static int                  sync_fd          = -1;
 
-static ev_timer sync_timer;
+/*
+ * Connection state machine. A failed connect is retried with a jittered,
+ * exponentially growing delay, so a restarting mesh agent is not flooded by
+ * every manager at once. The socket path is also watched with ev_stat (backed
+ * by inotify), so the client connects as soon as the agent creates it.
+ */
+static struct
+{
+    ev_timer            timer;
+    ev_stat             stat;
+    bool                stat_active;
+    ev_tstamp           delay;          // next retry delay, before jitter
+    ev_tstamp           down_since;     // 0 while connected
+    ev_tstamp           connected_at;
+    uint32_t            attempts;       // since down_since
+
+    // Counters
+    uint64_t            connects;
+    uint64_t            attempts_total;
+    ev_tstamp           latency_max;
+    uint64_t            replayed;
+} sync_conn;
+
+/*
+ * Last message sent for each sync_msg_key(). Messages sent while disconnected
+ * only update this snapshot, and the whole snapshot is replayed on connect,
+ * so the mesh agent does not miss state changes made while it was down.
+ */
+static struct
+{
+    struct
+    {
+        uint32_t        key;
+        MeshSync        msg;
+    } entries[SYNC_STATE_MAX];
+    uint32_t            count;
+} sync_state;
+
+/*
+ * Receive buffer of the current connection. Frames may be split or
+ * concatenated by the kernel arbitrarily; bytes of an incomplete frame stay
+ * here until the rest of it arrives.
+ */
+static struct
+{
+    uint8_t             buf[SYNC_RX_BUF_MSGS * sizeof(MeshSync)];
+    size_t              len;
+
+    // Counters
+    uint64_t            wakeups;
+    uint64_t            frames;
+    uint64_t            split;      // wakeups which left a partial frame
+} sync_rx;
+
+/*
+ * Outbound queue, used whenever the socket cannot take a whole message right
+ * away. It is flushed from an EV_WRITE watcher. Messages which only carry the
+ * latest state of a VAP or radio replace a queued message with the same key,
+ * so a slow mesh agent gets the final state instead of every intermediate one.
+ */
+static struct
+{
+    ev_io               evio;
+    MeshSync            msgs[SYNC_TX_QUEUE_MAX];
+    uint32_t            head;
+    uint32_t            count;
+    size_t              head_off;   // bytes of the head message already sent
+
+    // Counters
+    uint64_t            queued;
+    uint64_t            coalesced;
+    uint64_t            dropped;
+} sync_tx;
 
 /*****************************************************************************/
 
@@ -112,6 +201,174 @@ static void                 sync_reconnect(void);
 
 /*****************************************************************************/
 
+/*
+ * Resync requests from mesh agent messages only mark the affected radio or
+ * VAP dirty. The marked state is refreshed once the messages stop coming for
+ * SYNC_RESYNC_DEBOUNCE, but no later than SYNC_RESYNC_MAX_DELAY after the
+ * first request, so a config replay after reconnect costs one pass.
+ * MESH_WIFI_RESET still requests a full resync.
+ */
+static struct
+{
+    ev_timer            timer;
+    bool                timer_init;
+    bool                full;
+    uint32_t            radio_mask;
+    uint64_t            vap_mask;
+    ev_tstamp           first;      // time of the first pending request
+
+    // Counters
+    uint64_t            requests;
+    uint64_t            passes;
+} sync_resync;
+
+static void sync_resync_task(struct ev_loop *loop, ev_timer *timer, int revents)
+{
+    uint32_t radio_mask = sync_resync.radio_mask;
+    uint64_t vap_mask = sync_resync.vap_mask;
+    bool full = sync_resync.full;
+    wifi_vap_info_map_t vap_info_map;
+    wifi_vap_info_t *vap_info;
+    wifi_vap_index_t vap_index;
+    UINT j;
+    INT i;
+
+    sync_resync.radio_mask = 0;
+    sync_resync.vap_mask = 0;
+    sync_resync.full = false;
+    sync_resync.passes++;
+
+    LOGD("Re-sync triggered by MeshAgent (%llu requests, %llu resyncs avoided)",
+         (unsigned long long)sync_resync.requests,
+         (unsigned long long)(sync_resync.requests - sync_resync.passes));
+
+    if (full)
+    {
+        radio_trigger_resync();
+        return;
+    }
+
+    for (i = 0; radio_mask != 0; i++, radio_mask >>= 1)
+    {
+        if (!(radio_mask & 1)) continue;
+
+        if (!radio_state_update(i))
+        {
+            LOGW("Cannot update radio state for radio index %d", i);
+            continue;
+        }
+
+        // VIF_State.channel follows the radio, refresh its VAPs as well
+        memset(&vap_info_map, 0, sizeof(vap_info_map));
+        if (wifi_getRadioVapInfoMap(i, &vap_info_map) != RETURN_OK)
+        {
+            LOGE("%s: cannot get vap info map for radio index = %d", __func__, i);
+            continue;
+        }
+
+        for (j = 0; j < vap_info_map.num_vaps; j++)
+        {
+            vap_index = vap_info_map.vap_array[j].vap_index;
+
+            if (vap_index >= SYNC_RESYNC_VAP_MAX) continue;
+            if (!vap_controlled(vap_info_map.vap_array[j].vap_name)) continue;
+
+            vap_mask |= 1ULL << vap_index;
+        }
+    }
+
+    for (i = 0; vap_mask != 0; i++, vap_mask >>= 1)
+    {
+        if (!(vap_mask & 1)) continue;
+
+        if (!ssid_index_to_vap_info(i, &vap_info_map, &vap_info))
+        {
+            LOGW("Cannot get VAP info for SSID index %d", i);
+            continue;
+        }
+
+        // Silently skip ifaces that are not enabled, as a full resync does
+        if (!vap_info->u.bss_info.enabled) continue;
+
+        if (!clients_hal_fetch_existing(i))
+        {
+            LOGW("Fetching existing clients for SSID index %d failed", i);
+        }
+        if (!vif_state_update(i))
+        {
+            LOGW("Cannot update VIF state for SSID index %d", i);
+        }
+    }
+}
+
+static void sync_resync_schedule(void)
+{
+    ev_tstamp now = ev_now(wifihal_evloop);
+    ev_tstamp delay;
+
+    sync_resync.requests++;
+
+    if (!sync_resync.timer_init)
+    {
+        ev_timer_init(&sync_resync.timer, sync_resync_task, 0, 0);
+        sync_resync.timer_init = true;
+    }
+
+    if (!ev_is_active(&sync_resync.timer)) sync_resync.first = now;
+
+    delay = SYNC_RESYNC_DEBOUNCE;
+    if (now + delay > sync_resync.first + SYNC_RESYNC_MAX_DELAY)
+    {
+        delay = sync_resync.first + SYNC_RESYNC_MAX_DELAY - now;
+        if (delay < 0) delay = 0;
+    }
+
+    ev_timer_stop(wifihal_evloop, &sync_resync.timer);
+    ev_timer_set(&sync_resync.timer, delay, 0);
+    ev_timer_start(wifihal_evloop, &sync_resync.timer);
+}
+
+static void sync_resync_all(void)
+{
+    if (sync_mgr != SYNC_MGR_WM) return;
+
+    sync_resync.full = true;
+    sync_resync_schedule();
+}
+
+static void sync_resync_radio(INT radio_index)
+{
+    if (sync_mgr != SYNC_MGR_WM) return;
+
+    if (radio_index < 0 || radio_index >= 32)
+    {
+        sync_resync.full = true;
+    }
+    else
+    {
+        sync_resync.radio_mask |= 1U << radio_index;
+    }
+    sync_resync_schedule();
+}
+
+static void sync_resync_vap(INT ssid_index, const char *ssid_ifname)
+{
+    if (sync_mgr != SYNC_MGR_WM) return;
+
+    // Full resync skips those as well
+    if (!vap_controlled(ssid_ifname)) return;
+
+    if (ssid_index < 0 || ssid_index >= SYNC_RESYNC_VAP_MAX)
+    {
+        sync_resync.full = true;
+    }
+    else
+    {
+        sync_resync.vap_mask |= 1ULL << ssid_index;
+    }
+    sync_resync_schedule();
+}
+
 static char* sync_message_name(int msg_id)
 {
     static char         tmp[32];
@@ -148,7 +405,6 @@ static void sync_process_msg(MeshSync *mp)
     INT                             ret;
     char                            radio_ifname[128];
     char                            ssid_ifname[128];
-    bool                            resync = false;
 
 
 #define MK_SSID_IFNAME(idx)     do { \
@@ -187,7 +443,7 @@ static void sync_process_msg(MeshSync *mp)
             {
                 LOGE("Cannot update config table for SSID: %s", mp->data.wifiSSIDName.ssid);
             }
-            resync = true;
+            sync_resync_vap(mp->data.wifiSSIDName.index, ssid_ifname);
             break;
 
         case MESH_WIFI_AP_SECURITY:
@@ -208,7 +464,7 @@ static void sync_process_msg(MeshSync *mp)
             {
                 LOGE("Cannot update config table for SSID: %s", mp->data.wifiSSIDName.ssid);
             }
-            resync = true;
+            sync_resync_vap(mp->data.wifiAPSecurity.index, ssid_ifname);
             break;
 
         case MESH_WIFI_AP_ADD_ACL_DEVICE:
@@ -229,7 +485,7 @@ static void sync_process_msg(MeshSync *mp)
                     LOGE("Cannot add ACL from Mesh Agent, index=%d", mp->data.wifiAPAddAclDevice.index);
                 }
             }
-            resync = true;
+            sync_resync_vap(mp->data.wifiAPAddAclDevice.index, ssid_ifname);
 #endif
             break;
 
@@ -251,7 +507,7 @@ static void sync_process_msg(MeshSync *mp)
                     LOGE("Cannot del ACL from Mesh Agent, index=%d", mp->data.wifiAPDelAclDevice.index);
                 }
             }
-            resync = true;
+            sync_resync_vap(mp->data.wifiAPDelAclDevice.index, ssid_ifname);
 #endif
             break;
 
@@ -276,7 +532,7 @@ static void sync_process_msg(MeshSync *mp)
                     LOGE("Cannot update ACL mode from Mesh Agent, index=%d", mp->data.wifiMacAddrControlMode.index);
                 }
             }
-            resync = true;
+            sync_resync_vap(mp->data.wifiMacAddrControlMode.index, ssid_ifname);
 #endif
             break;
 
@@ -292,7 +548,7 @@ static void sync_process_msg(MeshSync *mp)
             LOGI("... %s SSID advertise now '%s'",
                     ssid_ifname,
                     mp->data.wifiSSIDAdvertise.enable ? "true" : "false");
-            resync = true;
+            sync_resync_vap(mp->data.wifiSSIDAdvertise.index, ssid_ifname);
             break;
 
         case MESH_URL_CHANGE:
@@ -304,7 +560,7 @@ static void sync_process_msg(MeshSync *mp)
         case MESH_WIFI_RESET:
             BREAK_IF_NOT_MGR(WM);
             LOGI("... Wifi Reset '%s'", mp->data.wifiReset.reset ? "true" : "false");
-            resync = true;
+            sync_resync_all();
             break;
 
         case MESH_SUBNET_CHANGE:
@@ -323,7 +579,7 @@ static void sync_process_msg(MeshSync *mp)
                 break;
             }
             LOGI("... %s: Kick all devices", ssid_ifname);
-            resync = true;
+            sync_resync_vap(mp->data.wifiAPKickAllAssocDevices.index, ssid_ifname);
             break;
 
         case MESH_WIFI_AP_KICK_ASSOC_DEVICE:
@@ -336,7 +592,7 @@ static void sync_process_msg(MeshSync *mp)
                 break;
             }
             LOGI("... %s: Kick device '%s'", ssid_ifname, mp->data.wifiAPKickAssocDevice.mac);
-            resync = true;
+            sync_resync_vap(mp->data.wifiAPKickAssocDevice.index, ssid_ifname);
             break;
 
         case MESH_WIFI_RADIO_CHANNEL:
@@ -350,7 +606,7 @@ static void sync_process_msg(MeshSync *mp)
                 break;
             }
             LOGI("... %s: changed channel to %d", radio_ifname, mp->data.wifiRadioChannel.channel);
-            resync = true;
+            sync_resync_radio(radioIndex);
             break;
 
         case MESH_WIFI_RADIO_CHANNEL_MODE:
@@ -369,7 +625,7 @@ static void sync_process_msg(MeshSync *mp)
                     mp->data.wifiRadioChannelMode.gOnlyFlag ? "true" : "false",
                     mp->data.wifiRadioChannelMode.nOnlyFlag ? "true" : "false",
                     mp->data.wifiRadioChannelMode.acOnlyFlag ? "true" : "false");
-            resync = true;
+            sync_resync_radio(radioIndex);
             break;
 
         case MESH_STATE_CHANGE:
@@ -463,19 +719,49 @@ static void sync_process_msg(MeshSync *mp)
     }
 #undef MK_SSID_IFNAME
 #undef MK_RADIO_IFNAME
-    if (sync_mgr == SYNC_MGR_WM && resync == true)
+
+    return;
+}
+
+// Process all complete frames in the receive buffer
+static void sync_rx_parse(void)
+{
+    MeshSync            mmsg;
+    size_t              off = 0;
+    int                 fd = sync_fd;
+
+    while (sync_rx.len - off >= sizeof(mmsg))
     {
-        LOGD("Re-sync triggered by MeshAgent");
-        radio_trigger_resync();
+        // Copy out, frames in the buffer are not aligned
+        memcpy(&mmsg, sync_rx.buf + off, sizeof(mmsg));
+        off += sizeof(mmsg);
+        sync_rx.frames++;
+
+        if (mmsg.msgType >= MESH_SYNC_MSG_TOTAL)
+        {
+            LOGE("Sync client received unsupported msg type (%d >= %d)",
+                 mmsg.msgType, MESH_SYNC_MSG_TOTAL);
+            continue;
+        }
+
+        sync_process_msg(&mmsg);
+
+        // Connection was reset while processing, buffer is no longer valid
+        if (sync_fd != fd) return;
     }
 
-    return;
+    if (off > 0)
+    {
+        memmove(sync_rx.buf, sync_rx.buf + off, sync_rx.len - off);
+        sync_rx.len -= off;
+    }
 }
 
 static void sync_evio_cb(struct ev_loop *loop, ev_io *watcher, int revents)
 {
-    MeshSync            mmsg;
-    int                 ret;
+    ssize_t             ret;
+    int                 reads;
+    int                 fd = sync_fd;
 
     if (revents & EV_ERROR)
     {
@@ -484,68 +770,270 @@ static void sync_evio_cb(struct ev_loop *loop, ev_io *watcher, int revents)
         return;
     }
 
-    ret = recv(sync_fd, &mmsg, sizeof(mmsg), MSG_DONTWAIT);
-    if (ret <= 0)
+    sync_rx.wakeups++;
+
+    for (reads = 0; reads < SYNC_RX_READS_MAX; reads++)
     {
-        LOGE("Sync client failed to read message, errno %d, reconnecting...", errno);
-        sync_reconnect();
-        return;
+        ret = recv(sync_fd, sync_rx.buf + sync_rx.len, sizeof(sync_rx.buf) - sync_rx.len, MSG_DONTWAIT);
+        if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (ret < 0 && errno == EINTR) continue;
+        if (ret <= 0)
+        {
+            LOGE("Sync client failed to read message, errno %d, reconnecting...", ret == 0 ? 0 : errno);
+            sync_reconnect();
+            return;
+        }
+
+        sync_rx.len += ret;
+        sync_rx_parse();
+        if (sync_fd != fd) return;
     }
-    else if (ret != sizeof(mmsg))
+
+    if (sync_rx.len > 0)
     {
-        LOGE("Sync client received malformed packet (length %d != %d)", ret, (int)sizeof(mmsg));
-        return;
+        sync_rx.split++;
+        LOGT("Sync client holding %zu bytes of a partial frame", sync_rx.len);
     }
+}
 
-    if (mmsg.msgType >= MESH_SYNC_MSG_TOTAL)
+// Messages carrying the latest state of one VAP or radio
+static bool sync_msg_key(const MeshSync *mp, uint32_t *key)
+{
+    uint32_t index;
+
+    switch (mp->msgType)
     {
-        LOGE("Sync client received unsupported msg type (%d >= %d)",
-             mmsg.msgType, MESH_SYNC_MSG_TOTAL);
-        return;
+        case MESH_WIFI_SSID_NAME:
+            index = mp->data.wifiSSIDName.index;
+            break;
+        case MESH_WIFI_AP_SECURITY:
+            index = mp->data.wifiAPSecurity.index;
+            break;
+        case MESH_WIFI_RADIO_CHANNEL:
+            index = mp->data.wifiRadioChannel.index;
+            break;
+        case MESH_WIFI_RADIO_CHANNEL_BW:
+            index = mp->data.wifiRadioChannelBw.index;
+            break;
+        case MESH_WIFI_SSID_ADVERTISE:
+            index = mp->data.wifiSSIDAdvertise.index;
+            break;
+        case MESH_WIFI_STATUS:
+            index = 0;
+            break;
+        default:
+            return false;
     }
 
-    sync_process_msg(&mmsg);
-    return;
+    *key = ((uint32_t)mp->msgType << 16) | (index & 0xffff);
+    return true;
 }
 
-static bool sync_send_msg(MeshSync *mp)
+// Returns true if the message is part of the snapshot replayed on connect
+static bool sync_state_update(const MeshSync *mp)
 {
-    int ret;
+    uint32_t key;
+    uint32_t i;
 
-    if (sync_fd < 0)
+    if (!sync_msg_key(mp, &key)) return false;
+
+    for (i = 0; i < sync_state.count; i++)
     {
-        LOGE("Sync could not send message type \"%s\", not connected...",
+        if (sync_state.entries[i].key == key) break;
+    }
+
+    if (i == SYNC_STATE_MAX)
+    {
+        LOGW("Sync client state snapshot is full, message type \"%s\" will not be replayed",
              sync_message_name(mp->msgType));
         return false;
     }
 
-    ret = send(sync_fd, (void *)mp, sizeof(*mp), MSG_DONTWAIT);
-    if (ret <= 0)
+    if (i == sync_state.count) sync_state.count++;
+    sync_state.entries[i].key = key;
+    memcpy(&sync_state.entries[i].msg, mp, sizeof(*mp));
+
+    return true;
+}
+
+static void sync_tx_report(void)
+{
+    LOGD("Sync client tx: pending=%u queued=%llu coalesced=%llu dropped=%llu",
+         sync_tx.count,
+         (unsigned long long)sync_tx.queued,
+         (unsigned long long)sync_tx.coalesced,
+         (unsigned long long)sync_tx.dropped);
+}
+
+static bool sync_tx_enqueue(const MeshSync *mp)
+{
+    uint32_t key;
+    uint32_t qkey;
+    uint32_t i;
+    MeshSync *qmsg;
+
+    if (sync_msg_key(mp, &key))
     {
-        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        // The head may be partially sent already, never rewrite it
+        for (i = (sync_tx.head_off > 0) ? 1 : 0; i < sync_tx.count; i++)
         {
-            LOGW("Sync client was too busy to send message type \"%s\", dropped...",
-                 sync_message_name(mp->msgType));
+            qmsg = &sync_tx.msgs[(sync_tx.head + i) % SYNC_TX_QUEUE_MAX];
+            if (sync_msg_key(qmsg, &qkey) && qkey == key)
+            {
+                memcpy(qmsg, mp, sizeof(*qmsg));
+                sync_tx.coalesced++;
+                return true;
+            }
         }
-        else
+    }
+
+    if (sync_tx.count == SYNC_TX_QUEUE_MAX)
+    {
+        sync_tx.dropped++;
+        LOGW("Sync client queue is full, message type \"%s\" dropped...",
+             sync_message_name(mp->msgType));
+        return false;
+    }
+
+    memcpy(&sync_tx.msgs[(sync_tx.head + sync_tx.count) % SYNC_TX_QUEUE_MAX], mp, sizeof(*mp));
+    sync_tx.count++;
+    sync_tx.queued++;
+
+    return true;
+}
+
+// Write queued messages until the socket is full; false on socket error
+static bool sync_tx_flush(void)
+{
+    const uint8_t *data;
+    ssize_t ret;
+
+    while (sync_tx.count > 0)
+    {
+        data = (const uint8_t *)&sync_tx.msgs[sync_tx.head];
+        ret = send(sync_fd, data + sync_tx.head_off, sizeof(MeshSync) - sync_tx.head_off,
+                   MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (ret < 0)
         {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (errno == EINTR) continue;
+
             LOGE("Sync client failed to send message type \"%s\", errno = %d",
-                 sync_message_name(mp->msgType), errno);
+                 sync_message_name(sync_tx.msgs[sync_tx.head].msgType), errno);
+            return false;
         }
 
+        sync_tx.head_off += ret;
+        if (sync_tx.head_off < sizeof(MeshSync)) break;
+
+        sync_tx.head_off = 0;
+        sync_tx.head = (sync_tx.head + 1) % SYNC_TX_QUEUE_MAX;
+        sync_tx.count--;
+    }
+
+    if (sync_tx.count > 0)
+    {
+        if (!ev_is_active(&sync_tx.evio)) ev_io_start(wifihal_evloop, &sync_tx.evio);
+    }
+    else if (ev_is_active(&sync_tx.evio))
+    {
+        ev_io_stop(wifihal_evloop, &sync_tx.evio);
+    }
+
+    return true;
+}
+
+static void sync_tx_evio_cb(struct ev_loop *loop, ev_io *watcher, int revents)
+{
+    if ((revents & EV_ERROR) || !sync_tx_flush())
+    {
+        LOGE("Sync client failed to flush queued messages, reconnecting...");
+        sync_reconnect();
+    }
+}
+
+static bool sync_send_msg(MeshSync *mp)
+{
+    bool cached;
+
+    cached = sync_state_update(mp);
+
+    if (sync_fd < 0)
+    {
+        if (cached)
+        {
+            LOGI("Sync client not connected, message type \"%s\" will be sent on connect",
+                 sync_message_name(mp->msgType));
+            return true;
+        }
+
+        LOGE("Sync could not send message type \"%s\", not connected...",
+             sync_message_name(mp->msgType));
         return false;
     }
 
+    if (!sync_tx_enqueue(mp)) return false;
+
+    if (sync_tx.count > 0 && !ev_is_active(&sync_tx.evio))
+    {
+        // Nothing was waiting for the socket, try to write right away
+        if (!sync_tx_flush())
+        {
+            sync_reconnect();
+            return false;
+        }
+    }
+
     return true;
 }
 
-static void sync_task_connect(struct ev_loop *loop, ev_timer *timer_ptr, int revents)
+// Queue the state snapshot ahead of anything sent from now on
+static uint32_t sync_state_replay(void)
+{
+    uint32_t i;
+    uint32_t num = 0;
+
+    for (i = 0; i < sync_state.count; i++)
+    {
+        if (sync_tx_enqueue(&sync_state.entries[i].msg)) num++;
+    }
+
+    return num;
+}
+
+static void sync_connect_schedule(ev_tstamp delay)
+{
+    double jitter;
+
+    // Spread the retries of all managers reconnecting at the same time
+    jitter = 1.0 - SYNC_RETRY_JITTER + 2.0 * SYNC_RETRY_JITTER * ((double)random() / RAND_MAX);
+
+    ev_timer_stop(wifihal_evloop, &sync_conn.timer);
+    ev_timer_set(&sync_conn.timer, delay * jitter, 0);
+    ev_timer_start(wifihal_evloop, &sync_conn.timer);
+}
+
+// Retry after the current backoff delay, then back off further
+static void sync_connect_retry(void)
+{
+    sync_connect_schedule(sync_conn.delay);
+
+    sync_conn.delay *= 2;
+    if (sync_conn.delay > SYNC_RETRY_MAX) sync_conn.delay = SYNC_RETRY_MAX;
+}
+
+static bool sync_connect(void)
 {
     struct sockaddr_un  addr;
     const char          *uds_path = MESH_SOCKET_PATH_NAME;
+    ev_tstamp           latency;
+    uint32_t            replayed;
     int                 ret;
     int                 fd;
 
+    sync_conn.attempts++;
+    sync_conn.attempts_total++;
+
     // Setup address of socket
     memset(&addr, 0, sizeof(addr));
     addr.sun_family = AF_UNIX;
@@ -567,39 +1055,90 @@ static void sync_task_connect(struct ev_loop *loop, ev_timer *timer_ptr, int rev
     if (fd < 0)
     {
         LOGE("Sync client failed to connect -- socket creation failure, errno = %d", errno);
-        return;
+        return false;
     }
 
     // Connect to Mesh-Agent
     ret = connect(fd, (struct sockaddr *)&addr, sizeof(addr));
     if (ret < 0)
     {
-        LOGE("Sync client failed to connect, errno = %d", errno);
+        // Expected while the agent is restarting, do not flood the log
+        if (sync_conn.attempts == 1)
+        {
+            LOGE("Sync client failed to connect, errno = %d", errno);
+        }
+        else
+        {
+            LOGD("Sync client failed to connect, errno = %d (attempt %u)", errno, sync_conn.attempts);
+        }
         close(fd);
-        return;
+        return false;
     }
 
     // Add to libev
     ev_io_init(&sync_evio, sync_evio_cb, fd, EV_READ);
     ev_io_start(wifihal_evloop, &sync_evio);
+    ev_io_init(&sync_tx.evio, sync_tx_evio_cb, fd, EV_WRITE);
 
-    LOGI("Sync client connected to Mesh-Agent (fd %d)", fd);
     sync_fd = fd;
 
+    latency = ev_time() - sync_conn.down_since;
+    if (latency > sync_conn.latency_max) sync_conn.latency_max = latency;
+
+    // Messages queued on the previous connection are sent first, the
+    // snapshot replaces queued messages with the same key
+    replayed = sync_state_replay();
+    sync_conn.replayed += replayed;
+    sync_conn.connects++;
+
+    LOGI("Sync client connected to Mesh-Agent (fd %d) after %.2f s and %u attempts, replaying %u messages",
+         fd, latency, sync_conn.attempts, replayed);
+    LOGD("Sync client connections: connects=%llu attempts=%llu latency_max=%.2f s replayed=%llu",
+         (unsigned long long)sync_conn.connects,
+         (unsigned long long)sync_conn.attempts_total,
+         sync_conn.latency_max,
+         (unsigned long long)sync_conn.replayed);
+
+    sync_conn.down_since = 0;
+    sync_conn.connected_at = ev_time();
+    sync_conn.attempts = 0;
+
+    if (sync_tx.count > 0) ev_io_start(wifihal_evloop, &sync_tx.evio);
+
     if (sync_on_connect_cb)
     {
         sync_on_connect_cb();
     }
 
-    ev_timer_stop(loop, timer_ptr);
+    return true;
+}
 
-    return;
+static void sync_task_connect(struct ev_loop *loop, ev_timer *timer_ptr, int revents)
+{
+    if (sync_fd >= 0 || sync_connect()) return;
+
+    sync_connect_retry();
+}
+
+// The agent socket path was created, removed or changed
+static void sync_stat_cb(struct ev_loop *loop, ev_stat *w, int revents)
+{
+    if (sync_fd >= 0 || w->attr.st_nlink == 0) return;
+
+    LOGD("Sync client noticed %s, connecting...", w->path);
+
+    ev_timer_stop(wifihal_evloop, &sync_conn.timer);
+    if (sync_connect()) return;
+
+    // Socket exists but the agent is not listening yet
+    sync_conn.delay = SYNC_RETRY_MIN;
+    sync_connect_retry();
 }
 
 static void sync_disconnect(void)
 {
     // Cancel any connection tasks
-    ev_timer_stop(EV_DEFAULT_ &sync_timer);
+    ev_timer_stop(wifihal_evloop, &sync_conn.timer);
 
     // Nothing else to do if not connected
     if (sync_fd < 0)
@@ -609,21 +1148,50 @@ static void sync_disconnect(void)
 
     // Stop EVIO and disconnect
     ev_io_stop(wifihal_evloop, &sync_evio);
+    ev_io_stop(wifihal_evloop, &sync_tx.evio);
     close(sync_fd);
     sync_fd = -1;
 
+    LOGD("Sync client rx: wakeups=%llu frames=%llu split=%llu, dropping %zu buffered bytes",
+         (unsigned long long)sync_rx.wakeups,
+         (unsigned long long)sync_rx.frames,
+         (unsigned long long)sync_rx.split,
+         sync_rx.len);
+    sync_rx.len = 0;
+
+    // A partially sent message is resent whole on the next connection
+    sync_tx.head_off = 0;
+    sync_tx_report();
+
     LOGI("Sync client disconnected from Mesh-Agent");
     return;
 }
 
 static void sync_reconnect(void)
 {
+    ev_tstamp now = ev_time();
+
     // Disconnect current socket if one exists
     sync_disconnect();
 
-    // Schedule task to connect
-    ev_timer_init(&sync_timer, sync_task_connect, 0, SYNC_RETRY);
-    ev_timer_again(EV_DEFAULT_ &sync_timer);
+    if (sync_conn.down_since == 0)
+    {
+        sync_conn.down_since = now;
+        sync_conn.attempts = 0;
+    }
+
+    ev_timer_init(&sync_conn.timer, sync_task_connect, 0, 0);
+
+    // Keep backing off if the agent keeps dropping fresh connections
+    if (sync_conn.connected_at != 0 && now - sync_conn.connected_at < SYNC_RETRY_STABLE)
+    {
+        sync_connect_retry();
+        return;
+    }
+
+    // First attempt right away, retries after SYNC_RETRY_MIN, 2 * SYNC_RETRY_MIN...
+    sync_conn.delay = SYNC_RETRY_MIN;
+    sync_connect_schedule(0);
 
     return;
 }
@@ -638,6 +1206,14 @@ void sync_init(sync_mgr_t mgr, sync_on_connect_cb_t sync_cb)
     }
     sync_on_connect_cb = sync_cb;
 
+    // Abstract sockets have no file system entry to watch
+    if (*MESH_SOCKET_PATH_NAME != '\0')
+    {
+        ev_stat_init(&sync_conn.stat, sync_stat_cb, MESH_SOCKET_PATH_NAME, 0.0);
+        ev_stat_start(wifihal_evloop, &sync_conn.stat);
+        sync_conn.stat_active = true;
+    }
+
     // Kick of connect task
     sync_reconnect();
 
@@ -655,6 +1231,18 @@ bool sync_cleanup(void)
 
     sync_disconnect();
 
+    if (sync_conn.stat_active)
+    {
+        ev_stat_stop(wifihal_evloop, &sync_conn.stat);
+        sync_conn.stat_active = false;
+    }
+    sync_conn.down_since = 0;
+
+    if (sync_resync.timer_init)
+    {
+        ev_timer_stop(wifihal_evloop, &sync_resync.timer);
+    }
+
     LOGN("Sync client cleaned up");
     sync_initialized = false;
 
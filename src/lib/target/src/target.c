@@ -129,10 +129,11 @@ bool target_close(target_init_opt_t opt, struct ev_loop *loop)
         case TARGET_INIT_MGR_WM:
 #ifndef CONFIG_RDK_DISABLE_SYNC
             sync_cleanup();
-            /* fall through */
 #endif
+            break;
 
         case TARGET_INIT_MGR_SM:
+            stats_cleanup();
             break;
 
         default:
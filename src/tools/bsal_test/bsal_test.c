@@ -0,0 +1,814 @@
+/*
+Copyright (c) 2021, Plume Design Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+   3. Neither the name of the Plume Design Inc. nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Plume Design Inc. BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * BSAL tests against a mock steering HAL
+ *
+ * bsal.c is compiled into this binary so the tests can look at the steering
+ * group directly. The HAL calls reached by the tests are mocked below; a
+ * mock VAP table describes which radio and band each apIndex belongs to.
+ *
+ * Usage: bsal_test [test...]     (runs every test if none is given)
+ *
+ *   groups         tri-band steering group with several VAPs per radio
+ *   clientinfo     client info cache behaviour and lookup cost at 5k clients
+ *   assoc          associated client lookups fall back to the HAL on a miss
+ *   neighbors      neighbor list pushes, rollback of failed immediate
+ *                  pushes and retries of deferred ones
+ *   btm            single BTM requests report the HAL result, batches share
+ *                  candidate lists and report per-client results (or
+ *                  "queued" with CONFIG_RDK_BSAL_BTM_ASYNC)
+ *   events         event ring overruns, batching and p99 latency, HAL events
+ *                  while VAPs are removed and added
+ */
+
+#include "bsal.c"
+
+#include <stdarg.h>
+#include <unistd.h>
+
+#define TEST_RADIOS             3
+#define TEST_VAPS_PER_RADIO     3
+#define TEST_AP_INDEX_BAD       (TEST_RADIOS * TEST_VAPS_PER_RADIO)
+#define TEST_CLIENTS            5000
+#define TEST_LOOKUP_ROUNDS      20
+#define TEST_EVENTS_RACE        20000
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: %s\n", __func__, __LINE__, #cond); \
+            g_failed++; \
+        } \
+    } while (0)
+
+static int g_failed;
+
+static void test_client_mac(uint8_t *mac, uint32_t n);
+
+/*****************************************************************************/
+/* Mock HAL                                                                  */
+/*****************************************************************************/
+
+static struct
+{
+    int                         set_group_calls;
+    UINT                        set_group_num;
+    INT                         set_group_ap[BSAL_GROUP_IFACE_MAX];
+    int                         set_neighbor_calls;
+    UINT                        set_neighbor_num;
+    INT                         set_neighbor_ret;
+    int                         btm_calls;          // atomic, may run on the BTM worker
+    int                         btm_candidates;     // atomic
+    INT                         btm_ret;
+    int                         assoc_calls;
+    UINT                        assoc_num;          // clients reported, see test_client_mac()
+    int                         events;             // delivered to the BM callback
+    int                         events_bad_ifname;
+} g_mock;
+
+// apIndex -> radio: r, r + 3, r + 6; radio TEST_RADIOS reports no usable band
+static INT mock_vap_radio(INT apIndex)
+{
+    return apIndex == TEST_AP_INDEX_BAD ? TEST_RADIOS : apIndex % TEST_RADIOS;
+}
+
+bool vif_ifname_to_idx(const char *ifname, INT *outSsidIndex)
+{
+    int idx;
+
+    if (sscanf(ifname, "test%d", &idx) != 1) return false;
+    if (idx < 0 || idx > TEST_AP_INDEX_BAD) return false;
+
+    *outSsidIndex = idx;
+    return true;
+}
+
+bool ssid_index_to_vap_info(UINT ssid_index, wifi_vap_info_map_t *map, wifi_vap_info_t **vap_info)
+{
+    return false;
+}
+
+INT wifi_getHalCapability(wifi_hal_capability_t *cap)
+{
+    cap->wifi_prop.numRadios = TEST_RADIOS;
+    return RETURN_OK;
+}
+
+INT wifi_steering_eventRegister(wifi_steering_eventCB_t event_cb)
+{
+    return RETURN_OK;
+}
+
+void wifi_steering_eventUnregister(void)
+{
+}
+
+#ifdef CONFIG_RDK_MGMT_FRAME_CB_SUPPORT
+INT wifi_mgmt_frame_callbacks_register(wifi_receivedMgmtFrame_callback func)
+{
+    return RETURN_OK;
+}
+#endif
+
+INT wifi_getSSIDRadioIndex(INT ssidIndex, INT *radioIndex)
+{
+    *radioIndex = mock_vap_radio(ssidIndex);
+    return RETURN_OK;
+}
+
+INT wifi_getRadioOperatingParameters(wifi_radio_index_t index, wifi_radio_operationParam_t *operationParam)
+{
+    static const wifi_freq_bands_t bands[TEST_RADIOS] =
+    {
+        WIFI_FREQUENCY_2_4_BAND,
+        WIFI_FREQUENCY_5_BAND,
+        WIFI_FREQUENCY_6_BAND,
+    };
+
+    memset(operationParam, 0, sizeof(*operationParam));
+    operationParam->band = index < TEST_RADIOS ? bands[index] : 0;
+    return RETURN_OK;
+}
+
+INT wifi_steering_setGroup(UINT steeringgroupIndex, UINT numElements, wifi_steering_apConfig_t *cfgArray)
+{
+    UINT i;
+
+    g_mock.set_group_calls++;
+    g_mock.set_group_num = numElements;
+    for (i = 0; i < numElements && i < BSAL_GROUP_IFACE_MAX; i++)
+    {
+        g_mock.set_group_ap[i] = cfgArray[i].apIndex;
+    }
+
+    return RETURN_OK;
+}
+
+INT wifi_setNeighborReports(UINT apIndex, UINT numNeighborReports, wifi_NeighborReport_t *neighborReports)
+{
+    g_mock.set_neighbor_calls++;
+    g_mock.set_neighbor_num = numNeighborReports;
+
+    return g_mock.set_neighbor_ret;
+}
+
+INT wifi_setBTMRequest(UINT apIndex, mac_address_t peerMac, wifi_BTMRequest_t *request)
+{
+    __atomic_fetch_add(&g_mock.btm_candidates, request->numCandidates, __ATOMIC_SEQ_CST);
+    __atomic_fetch_add(&g_mock.btm_calls, 1, __ATOMIC_SEQ_CST);
+
+    return g_mock.btm_ret;
+}
+
+INT wifi_getApAssociatedDeviceDiagnosticResult3(INT apIndex, wifi_associated_dev3_t **associated_dev_array,
+                                                UINT *output_array_size)
+{
+    UINT i;
+
+    g_mock.assoc_calls++;
+
+    *associated_dev_array = NULL;
+    *output_array_size = 0;
+    if (g_mock.assoc_num == 0) return RETURN_OK;
+
+    *associated_dev_array = calloc(g_mock.assoc_num, sizeof(**associated_dev_array));
+    if (*associated_dev_array == NULL) return RETURN_ERR;
+
+    for (i = 0; i < g_mock.assoc_num; i++)
+    {
+        test_client_mac((*associated_dev_array)[i].cli_MACAddress, i);
+        (*associated_dev_array)[i].cli_SNR = 30;
+    }
+    *output_array_size = g_mock.assoc_num;
+
+    return RETURN_OK;
+}
+
+/*****************************************************************************/
+/* Helpers                                                                   */
+/*****************************************************************************/
+
+static void test_event_cb(bsal_event_t *event)
+{
+    g_mock.events++;
+    if (strncmp(event->ifname, "test", 4) != 0) g_mock.events_bad_ifname++;
+}
+
+static void test_ifcfg(bsal_ifconfig_t *ifcfg, INT apIndex)
+{
+    memset(ifcfg, 0, sizeof(*ifcfg));
+    snprintf(ifcfg->ifname, sizeof(ifcfg->ifname), "test%d", apIndex);
+}
+
+static int test_iface_add(INT apIndex)
+{
+    bsal_ifconfig_t ifcfg;
+
+    test_ifcfg(&ifcfg, apIndex);
+    return target_bsal_iface_add(&ifcfg);
+}
+
+static int test_iface_remove(INT apIndex)
+{
+    bsal_ifconfig_t ifcfg;
+
+    test_ifcfg(&ifcfg, apIndex);
+    return target_bsal_iface_remove(&ifcfg);
+}
+
+static void test_client_mac(uint8_t *mac, uint32_t n)
+{
+    mac[0] = 0x02;
+    mac[1] = 0x00;
+    mac[2] = (n >> 24) & 0xff;
+    mac[3] = (n >> 16) & 0xff;
+    mac[4] = (n >> 8) & 0xff;
+    mac[5] = n & 0xff;
+}
+
+static uint64_t test_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Was apIndex part of the last group pushed to the HAL?
+static bool test_group_pushed(INT apIndex)
+{
+    UINT i;
+
+    for (i = 0; i < g_mock.set_group_num; i++)
+    {
+        if (g_mock.set_group_ap[i] == apIndex) return true;
+    }
+    return false;
+}
+
+/*****************************************************************************/
+/* Tests                                                                     */
+/*****************************************************************************/
+
+// Tri-band group with several VAPs per radio
+static void test_groups(void)
+{
+    const int vaps = TEST_RADIOS * TEST_VAPS_PER_RADIO;
+    const iface_t *iface;
+    int calls;
+    INT ap;
+
+    memset(&g_mock, 0, sizeof(g_mock));
+    CHECK(target_bsal_init(test_event_cb, EV_DEFAULT) == 0);
+    CHECK(group.radio_number == TEST_RADIOS);
+
+    // Radios 0 and 1 first: the group is not pushed until radio 2 has a VAP
+    for (ap = 0; ap < vaps; ap++)
+    {
+        if (mock_vap_radio(ap) == 2) continue;
+        CHECK(test_iface_add(ap) == 0);
+    }
+    CHECK(g_mock.set_group_calls == 0);
+
+    // Each remaining (6 GHz) VAP completes or extends the group
+    for (ap = 2; ap < vaps; ap += TEST_RADIOS)
+    {
+        calls = g_mock.set_group_calls;
+        CHECK(test_iface_add(ap) == 0);
+        CHECK(g_mock.set_group_calls == calls + 1);
+    }
+    CHECK(g_mock.set_group_num == (UINT)vaps);
+    CHECK(group.iface_number == (size_t)vaps);
+
+    for (ap = 0; ap < vaps; ap++)
+    {
+        CHECK(test_group_pushed(ap));
+
+        iface = group_get_iface_by_ap_index(ap);
+        CHECK(iface != NULL && iface->wifihal_cfg.apIndex == ap);
+        CHECK(iface != NULL && iface->radio_index == mock_vap_radio(ap));
+    }
+
+    // Adding the same VAP twice or a VAP of an unknown band must fail
+    CHECK(test_iface_add(0) != 0);
+    CHECK(test_iface_add(TEST_AP_INDEX_BAD) != 0);
+    CHECK(group_get_iface_by_name("test9") == NULL);
+    CHECK(group_get_iface_by_ap_index(TEST_AP_INDEX_BAD) == NULL);
+    CHECK(group.iface_number == (size_t)vaps);
+
+    // Removing one of several VAPs of a radio pushes the remaining ones
+    calls = g_mock.set_group_calls;
+    CHECK(test_iface_remove(4) == 0);
+    CHECK(g_mock.set_group_calls == calls + 1);
+    CHECK(g_mock.set_group_num == (UINT)vaps - 1);
+    CHECK(!test_group_pushed(4));
+    CHECK(group_get_iface_by_ap_index(4) == NULL);
+
+    // The slot freed above is reused
+    CHECK(test_iface_add(4) == 0);
+    CHECK(g_mock.set_group_num == (UINT)vaps);
+    CHECK(test_group_pushed(4));
+
+    // Once a radio has no VAP left, updates are postponed
+    CHECK(test_iface_remove(2) == 0);
+    CHECK(test_iface_remove(5) == 0);
+    calls = g_mock.set_group_calls;
+    CHECK(test_iface_remove(8) == 0);
+    CHECK(g_mock.set_group_calls == calls);
+
+    // ...and the last removal tears the group down
+    for (ap = 0; ap < vaps; ap++)
+    {
+        if (mock_vap_radio(ap) == 2) continue;
+        CHECK(test_iface_remove(ap) == 0);
+    }
+    CHECK(group.iface_number == 0);
+    CHECK(g_mock.set_group_calls == calls + 1);
+    CHECK(g_mock.set_group_num == 0);
+
+    CHECK(target_bsal_cleanup() == 0);
+}
+
+/*
+ * Connect TEST_CLIENTS clients, then time lookups of every cached client
+ * through the hashed cache and through a linear scan of the same entries,
+ * which is what the cache did before it was hashed.
+ */
+static void test_clientinfo(void)
+{
+    const uint32_t cached = TEST_CLIENTS < CONFIG_RDK_BSAL_CLIENT_CACHE_MAX
+                          ? TEST_CLIENTS : CONFIG_RDK_BSAL_CLIENT_CACHE_MAX;
+    const uint32_t first = TEST_CLIENTS - cached;
+    bsal_client_info_cache_t *client_info_cache;
+    wifi_steering_evConnect_t connect;
+    uint64_t hash_ns;
+    uint64_t scan_ns;
+    uint64_t start;
+    uint8_t mac[BSAL_MAC_ADDR_LEN];
+    uint32_t found;
+    uint32_t n;
+    int round;
+
+    bsal_client_info_cache_flush();
+    g_client_info_cache.hits = 0;
+    g_client_info_cache.misses = 0;
+    g_client_info_cache.evictions = 0;
+    g_client_info_cache.expirations = 0;
+
+    memset(&connect, 0, sizeof(connect));
+    connect.bandsCap = WIFI_FREQUENCY_5_BAND;
+    connect.isBTMSupported = 1;
+    for (n = 0; n < TEST_CLIENTS; n++)
+    {
+        test_client_mac(connect.client_mac, n);
+        bsal_client_info_update(&connect);
+    }
+
+    // Oldest clients are evicted once the cache is full
+    CHECK(g_client_info_cache.entries == cached);
+    CHECK(g_client_info_cache.evictions == TEST_CLIENTS - cached);
+    CHECK(g_client_info_cache.misses == TEST_CLIENTS);
+
+    // Reconnect updates the existing entry
+    test_client_mac(connect.client_mac, TEST_CLIENTS - 1);
+    connect.isBTMSupported = 0;
+    bsal_client_info_update(&connect);
+    CHECK(g_client_info_cache.entries == cached);
+    client_info_cache = bsal_find_client_info(connect.client_mac);
+    CHECK(client_info_cache != NULL && !client_info_cache->client.is_BTM_supported);
+    CHECK(client_info_cache != NULL && client_info_cache->client.band_cap_5G);
+
+    if (first > 0)
+    {
+        test_client_mac(mac, first - 1);
+        CHECK(bsal_find_client_info(mac) == NULL);
+    }
+
+    found = 0;
+    start = test_time_ns();
+    for (round = 0; round < TEST_LOOKUP_ROUNDS; round++)
+    {
+        for (n = first; n < TEST_CLIENTS; n++)
+        {
+            test_client_mac(mac, n);
+            if (bsal_find_client_info(mac) != NULL) found++;
+        }
+    }
+    hash_ns = test_time_ns() - start;
+    CHECK(found == cached * TEST_LOOKUP_ROUNDS);
+
+    found = 0;
+    start = test_time_ns();
+    for (round = 0; round < TEST_LOOKUP_ROUNDS; round++)
+    {
+        for (n = first; n < TEST_CLIENTS; n++)
+        {
+            test_client_mac(mac, n);
+            ds_dlist_foreach(&g_client_info_cache.lru, client_info_cache)
+            {
+                if (!memcmp(mac, client_info_cache->mac, BSAL_MAC_ADDR_LEN))
+                {
+                    found++;
+                    break;
+                }
+            }
+        }
+    }
+    scan_ns = test_time_ns() - start;
+    CHECK(found == cached * TEST_LOOKUP_ROUNDS);
+
+    printf("  %u clients connected, %u cached: lookup %llu ns hashed, %llu ns linear\n",
+           TEST_CLIENTS, cached,
+           (unsigned long long)(hash_ns / ((uint64_t)cached * TEST_LOOKUP_ROUNDS)),
+           (unsigned long long)(scan_ns / ((uint64_t)cached * TEST_LOOKUP_ROUNDS)));
+
+    // Disconnect drops the entry
+    bsal_client_info_remove(mac);
+    CHECK(g_client_info_cache.entries == cached - 1);
+    CHECK(bsal_find_client_info(mac) == NULL);
+
+    bsal_client_info_cache_flush();
+    CHECK(g_client_info_cache.entries == 0);
+}
+
+/*
+ * A client missing from the associated snapshot is looked up in the HAL, its
+ * CONNECT event may not have been drained from the event ring yet.
+ */
+static void test_assoc(void)
+{
+    bsal_client_info_t info;
+    uint8_t mac[BSAL_MAC_ADDR_LEN];
+    bsal_assoc_ap_t *ap;
+
+    memset(&g_mock, 0, sizeof(g_mock));
+    bsal_assoc_flush();
+
+    // First lookup reconciles the VAP
+    g_mock.assoc_num = 1;
+    test_client_mac(mac, 0);
+    CHECK(bsal_client_set_connected(0, mac, &info));
+    CHECK(info.connected && info.snr == 30);
+    CHECK(g_mock.assoc_calls == 1);
+
+    // Known client within BSAL_ASSOC_RECONCILE_SEC is answered from the snapshot
+    CHECK(bsal_client_set_connected(0, mac, &info));
+    CHECK(info.connected);
+    CHECK(g_mock.assoc_calls == 1);
+
+    // Client connected, but its CONNECT event is still in the ring
+    g_mock.assoc_num = 2;
+    test_client_mac(mac, 1);
+    CHECK(bsal_client_set_connected(0, mac, &info));
+    CHECK(info.connected);
+    CHECK(g_mock.assoc_calls == 2);
+    ap = bsal_assoc_ap_get(0);
+    CHECK(ap != NULL && ap->clients == 2);
+
+    // Client that is not connected at all
+    test_client_mac(mac, 2);
+    CHECK(bsal_client_set_connected(0, mac, &info));
+    CHECK(!info.connected);
+    CHECK(g_mock.assoc_calls == 3);
+
+    bsal_assoc_flush();
+}
+
+static void test_neigh(bsal_neigh_info_t *nr, uint8_t n)
+{
+    memset(nr, 0, sizeof(*nr));
+    nr->bssid[0] = 0x02;
+    nr->bssid[5] = n;
+    nr->op_class = 128;
+    nr->channel = 36;
+}
+
+static void test_neighbors(void)
+{
+    bsal_neigh_info_t nr;
+    bsal_neigh_set_t *set;
+    bsal_neighbor_t *stored;
+    int calls;
+    int n;
+
+    memset(&g_mock, 0, sizeof(g_mock));
+    g_mock.set_neighbor_ret = RETURN_OK;
+
+    // Without a loop changes are pushed right away, identical lists are skipped
+    test_neigh(&nr, 1);
+    CHECK(target_bsal_rrm_set_neighbor("test0", &nr) == 0);
+    CHECK(target_bsal_rrm_set_neighbor("test0", &nr) == 0);
+    CHECK(g_mock.set_neighbor_calls == 1);
+
+    // Unknown interface: the push is dropped and the change rolled back
+    CHECK(target_bsal_rrm_set_neighbor("bogus", &nr) != 0);
+    set = bsal_neigh_set_get("bogus", false);
+    CHECK(set != NULL && !set->dirty && set->count == 0);
+    CHECK(g_mock.set_neighbor_calls == 1);
+
+    // HAL failures are reported and leave the list as it was
+    g_mock.set_neighbor_ret = RETURN_ERR;
+    test_neigh(&nr, 2);
+    CHECK(target_bsal_rrm_set_neighbor("test0", &nr) != 0);
+    set = bsal_neigh_set_get("test0", false);
+    CHECK(set != NULL && set->count == 1);
+    CHECK(ds_tree_find(&set->neighbors, nr.bssid) == NULL);
+
+    test_neigh(&nr, 1);
+    nr.channel = 149;
+    CHECK(target_bsal_rrm_set_neighbor("test0", &nr) != 0);
+    stored = ds_tree_find(&set->neighbors, nr.bssid);
+    CHECK(stored != NULL && stored->nr.channel == 36);
+
+    CHECK(target_bsal_rrm_remove_neighbor("test0", &nr) != 0);
+    CHECK(set->count == 1);
+    CHECK(ds_tree_find(&set->neighbors, nr.bssid) != NULL);
+
+    g_mock.set_neighbor_ret = RETURN_OK;
+    CHECK(target_bsal_rrm_remove_neighbor("test0", &nr) == 0);
+    CHECK(set->count == 0);
+    CHECK(g_mock.set_neighbor_num == 0);
+
+    // With a loop a burst of changes results in one push
+    CHECK(target_bsal_init(test_event_cb, EV_DEFAULT) == 0);
+    calls = g_mock.set_neighbor_calls;
+    for (n = 1; n <= 30; n++)
+    {
+        test_neigh(&nr, n);
+        CHECK(target_bsal_rrm_set_neighbor("test0", &nr) == 0);
+    }
+    CHECK(g_mock.set_neighbor_calls == calls);
+    ev_run(EV_DEFAULT, EVRUN_ONCE);
+    CHECK(g_mock.set_neighbor_calls == calls + 1);
+    CHECK(g_mock.set_neighbor_num == 30);
+
+    // Deferred push: the change is kept and retried a limited number of times
+    g_mock.set_neighbor_ret = RETURN_ERR;
+    calls = g_mock.set_neighbor_calls;
+    test_neigh(&nr, 40);
+    CHECK(target_bsal_rrm_set_neighbor("test1", &nr) == 0);
+    do
+    {
+        ev_run(EV_DEFAULT, EVRUN_ONCE);
+    } while (ev_is_active(&g_neigh_commit_timer));
+    CHECK(g_mock.set_neighbor_calls == calls + BSAL_NEIGH_RETRY_MAX);
+    set = bsal_neigh_set_get("test1", false);
+    CHECK(set != NULL && !set->dirty && set->count == 1);
+
+    // The next change pushes the whole list, including the one that failed
+    g_mock.set_neighbor_ret = RETURN_OK;
+    test_neigh(&nr, 41);
+    CHECK(target_bsal_rrm_set_neighbor("test1", &nr) == 0);
+    ev_run(EV_DEFAULT, EVRUN_ONCE);
+    CHECK(g_mock.set_neighbor_calls == calls + BSAL_NEIGH_RETRY_MAX + 1);
+    CHECK(g_mock.set_neighbor_num == 2);
+    CHECK(target_bsal_rrm_remove_neighbor("test1", &nr) == 0);
+
+    CHECK(target_bsal_cleanup() == 0);
+}
+
+// Wait for the BTM worker to submit calls requests, 1 s at most
+static bool test_btm_wait(int calls)
+{
+    int i;
+
+    for (i = 0; i < 1000; i++)
+    {
+        if (__atomic_load_n(&g_mock.btm_calls, __ATOMIC_SEQ_CST) >= calls) return true;
+        usleep(1000);
+    }
+    return false;
+}
+
+static void test_btm(void)
+{
+    target_bsal_btm_batch_entry_t entries[6];
+    uint8_t macs[ARRAY_SIZE(entries)][BSAL_MAC_ADDR_LEN];
+    bsal_btm_params_t params[2];
+    size_t i;
+    INT ap;
+
+    memset(&g_mock, 0, sizeof(g_mock));
+    CHECK(target_bsal_init(test_event_cb, EV_DEFAULT) == 0);
+    for (ap = 0; ap < TEST_RADIOS; ap++) CHECK(test_iface_add(ap) == 0);
+
+    // Two candidate sets, one and two neighbors
+    memset(params, 0, sizeof(params));
+    test_neigh(&params[0].neigh[0], 1);
+    params[0].num_neigh = 1;
+    test_neigh(&params[1].neigh[0], 2);
+    test_neigh(&params[1].neigh[1], 3);
+    params[1].num_neigh = 2;
+
+    // A single request is sent right away and reports the HAL result
+    test_client_mac(macs[0], 0);
+    g_mock.btm_ret = RETURN_ERR;
+    CHECK(target_bsal_bss_tm_request("test0", macs[0], &params[0]) != 0);
+    CHECK(g_mock.btm_calls == 1);
+    g_mock.btm_ret = RETURN_OK;
+    CHECK(target_bsal_bss_tm_request("test0", macs[0], &params[0]) == 0);
+    CHECK(g_mock.btm_calls == 2);
+    CHECK(target_bsal_bss_tm_request("bogus", macs[0], &params[0]) != 0);
+    CHECK(g_mock.btm_calls == 2);
+
+    // Three clients to the first set, two to the second, one on an unknown iface
+    memset(entries, 0, sizeof(entries));
+    for (i = 0; i < ARRAY_SIZE(entries); i++)
+    {
+        test_client_mac(macs[i], i);
+        entries[i].ifname = i < 5 ? "test1" : "bogus";
+        entries[i].mac_addr = macs[i];
+        entries[i].btm_params = &params[i < 3 ? 0 : 1];
+    }
+
+    g_mock.btm_calls = 0;
+    g_mock.btm_candidates = 0;
+    CHECK(target_bsal_bss_tm_request_batch(entries, ARRAY_SIZE(entries)) != 0);
+    CHECK(entries[5].result == -1);
+#ifdef CONFIG_RDK_BSAL_BTM_ASYNC
+    for (i = 0; i < 5; i++)
+    {
+        CHECK(entries[i].result == TARGET_BSAL_BTM_QUEUED);
+        CHECK(entries[i].latency_us == 0);
+    }
+    CHECK(test_btm_wait(5));
+#else
+    for (i = 0; i < 5; i++) CHECK(entries[i].result == 0);
+#endif
+    CHECK(g_mock.btm_calls == 5);
+    CHECK(g_mock.btm_candidates == 3 * 1 + 2 * 2);
+
+#ifndef CONFIG_RDK_BSAL_BTM_ASYNC
+    // Synchronous batches report HAL failures per client
+    g_mock.btm_ret = RETURN_ERR;
+    CHECK(target_bsal_bss_tm_request_batch(entries, 2) != 0);
+    CHECK(entries[0].result == -1 && entries[1].result == -1);
+    g_mock.btm_ret = RETURN_OK;
+#endif
+
+    CHECK(target_bsal_cleanup() == 0);
+}
+
+// Hand an activity event for apIndex to the steering callback, as the HAL does
+static void test_hal_event(INT apIndex, uint32_t n)
+{
+    wifi_steering_event_t ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.type = WIFI_STEERING_EVENT_CLIENT_ACTIVITY;
+    ev.apIndex = apIndex;
+    test_client_mac(ev.data.activity.client_mac, n);
+    ev.data.activity.active = 1;
+    process_event(0, &ev);
+}
+
+static void *test_events_thread(void *arg)
+{
+    uint32_t n;
+
+    for (n = 0; n < TEST_EVENTS_RACE; n++)
+    {
+        test_hal_event(0, n);
+        if (n % 64 == 0) usleep(100);
+    }
+
+    return NULL;
+}
+
+/*
+ * Event ring: overruns are counted once it is full, everything queued is
+ * delivered in one batch, and the p99 latency is taken from the histogram.
+ * HAL events keep flowing while the VAP is removed and added again.
+ */
+static void test_events(void)
+{
+    pthread_t tid;
+    uint32_t n;
+    int i;
+
+    memset(&g_mock, 0, sizeof(g_mock));
+    CHECK(target_bsal_init(test_event_cb, EV_DEFAULT) == 0);
+    CHECK(test_iface_add(0) == 0);
+
+    pthread_mutex_lock(&g_event_ring.lock);
+    g_event_ring.queued = 0;
+    g_event_ring.delivered = 0;
+    g_event_ring.overruns = 0;
+    g_event_ring.batch_max = 0;
+    memset(g_event_ring.latency_hist, 0, sizeof(g_event_ring.latency_hist));
+    g_event_ring.latency_num = 0;
+    pthread_mutex_unlock(&g_event_ring.lock);
+
+    // Events of VAPs outside the group are dropped without taking a slot
+    test_hal_event(1, 0);
+    CHECK(g_event_ring.count == 0);
+
+    for (n = 0; n < BSAL_EVENT_RING_SIZE + 10; n++) test_hal_event(0, n);
+    CHECK(g_event_ring.count == BSAL_EVENT_RING_SIZE);
+    CHECK(g_event_ring.queued == BSAL_EVENT_RING_SIZE);
+    CHECK(g_event_ring.overruns == 10);
+
+    ev_run(EV_DEFAULT, EVRUN_NOWAIT);
+    CHECK(g_event_ring.count == 0);
+    CHECK(g_event_ring.delivered == BSAL_EVENT_RING_SIZE);
+    CHECK(g_event_ring.batch_max == BSAL_EVENT_RING_SIZE);
+    CHECK(g_event_ring.latency_num == BSAL_EVENT_RING_SIZE);
+    CHECK(g_mock.events == BSAL_EVENT_RING_SIZE);
+
+    // p99 is the first bucket covering 99% of the events
+    memset(g_event_ring.latency_hist, 0, sizeof(g_event_ring.latency_hist));
+    g_event_ring.latency_hist[3] = 990;
+    g_event_ring.latency_hist[10] = 10;
+    g_event_ring.latency_num = 1000;
+    CHECK(bsal_event_ring_p99_us() == 16);
+    g_event_ring.latency_hist[3] = 989;
+    g_event_ring.latency_hist[10] = 11;
+    CHECK(bsal_event_ring_p99_us() == 2048);
+    memset(g_event_ring.latency_hist, 0, sizeof(g_event_ring.latency_hist));
+    g_event_ring.latency_num = 0;
+
+    // Remove and add the VAP while the HAL thread is queueing its events
+    g_mock.events = 0;
+    CHECK(pthread_create(&tid, NULL, test_events_thread, NULL) == 0);
+    for (i = 0; i < 200; i++)
+    {
+        CHECK(test_iface_remove(0) == 0);
+        ev_run(EV_DEFAULT, EVRUN_NOWAIT);
+        CHECK(test_iface_add(0) == 0);
+        ev_run(EV_DEFAULT, EVRUN_NOWAIT);
+    }
+    pthread_join(tid, NULL);
+    ev_run(EV_DEFAULT, EVRUN_NOWAIT);
+    CHECK(g_event_ring.count == 0);
+    CHECK(g_mock.events > 0);
+    CHECK(g_mock.events_bad_ifname == 0);
+
+    CHECK(test_iface_remove(0) == 0);
+    CHECK(target_bsal_cleanup() == 0);
+}
+
+/*****************************************************************************/
+
+static const struct
+{
+    const char                 *name;
+    void                      (*fn)(void);
+} g_tests[] =
+{
+    { "groups",         test_groups },
+    { "clientinfo",     test_clientinfo },
+    { "assoc",          test_assoc },
+    { "neighbors",      test_neighbors },
+    { "btm",            test_btm },
+    { "events",         test_events },
+};
+
+int main(int argc, char **argv)
+{
+    bool run;
+    size_t t;
+    int a;
+
+    log_open("BSAL_TEST", LOG_OPEN_STDOUT);
+    log_severity_set(LOG_SEVERITY_WARN);
+
+    for (t = 0; t < ARRAY_SIZE(g_tests); t++)
+    {
+        run = (argc < 2);
+        for (a = 1; a < argc; a++)
+        {
+            if (!strcmp(argv[a], g_tests[t].name)) run = true;
+        }
+        if (!run) continue;
+
+        printf("%s\n", g_tests[t].name);
+        g_tests[t].fn();
+    }
+
+    printf("%s\n", g_failed ? "FAILED" : "PASSED");
+    return g_failed ? 1 : 0;
+}
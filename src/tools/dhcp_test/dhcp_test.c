@@ -0,0 +1,884 @@
+/*
+Copyright (c) 2021, Plume Design Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+   3. Neither the name of the Plume Design Inc. nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Plume Design Inc. BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * RDK DHCP server tests
+ *
+ * osn_dhcps.c is compiled into this binary. The tests create servers through
+ * the OSN API, write lease files in the dnsmasq format and run the same
+ * update path as the lease file watcher. All files shared with dnsmasq live
+ * in a scratch directory; this process stands in for dnsmasq in the PID
+ * file and counts the SIGHUPs it gets.
+ *
+ * Usage: dhcp_test [test...]     (runs every test if none is given)
+ *
+ *   update         single-lease edits of a 5k-lease file and range changes:
+ *                  only the affected server is notified; timed against a
+ *                  full reload
+ *   parse          lease line tokenizer against the regular expression it
+ *                  replaced: same result on valid and malformed lines, and
+ *                  a 10k-line benchmark of both
+ *   changed        lease change detection ignores the lease time and bytes
+ *                  past the end of strings
+ *   pool           lease pool and index footprint at 1k, 5k and 20k leases
+ *   route          leases routed by range, by interface subnet (a server on
+ *                  "lo") and to the only server left
+ *   conf           reservations and options rendered for dnsmasq, reloads
+ *                  only on content changes
+ */
+
+#include "osn_dhcps.c"
+
+#include <regex.h>
+#include <time.h>
+
+#define TEST_SERVERS            2
+#define TEST_UPDATE_LEASES      5000
+#define TEST_UPDATE_EDITS       100
+#define TEST_PARSE_LINES        10000
+#define TEST_PARSE_ROUNDS       5
+#define TEST_LINE_LEN           512
+#define TEST_POOL_LEASES_MAX    20000
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: %s\n", __func__, __LINE__, #cond); \
+            g_failed++; \
+        } \
+    } while (0)
+
+static int g_failed;
+
+/*****************************************************************************/
+/* Mocks                                                                     */
+/*****************************************************************************/
+
+struct ev_loop *wifihal_evloop;
+
+/*****************************************************************************/
+/* Helpers                                                                   */
+/*****************************************************************************/
+
+static char                 g_dir[] = "/tmp/dhcp_test.XXXXXX";
+static char                 g_leases_path[C_MAXPATH_LEN];
+static char                 g_hosts_dir[C_MAXPATH_LEN];
+static char                 g_opts_dir[C_MAXPATH_LEN];
+static char                 g_pid_path[C_MAXPATH_LEN];
+static volatile sig_atomic_t g_reloads;
+static osn_dhcp_server_t   *g_ds[TEST_SERVERS];
+static int                  g_notified[TEST_SERVERS];
+static int                  g_rev[TEST_POOL_LEASES_MAX];
+
+static void test_sighup(int sig)
+{
+    g_reloads++;
+}
+
+static uint64_t test_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void test_status_cb(osn_dhcp_server_t *ds, struct osn_dhcp_server_status *st)
+{
+    int i;
+
+    for (i = 0; i < TEST_SERVERS; i++)
+    {
+        if (ds == g_ds[i]) g_notified[i]++;
+    }
+}
+
+static int test_notified_total(void)
+{
+    int total = 0;
+    int i;
+
+    for (i = 0; i < TEST_SERVERS; i++) total += g_notified[i];
+
+    return total;
+}
+
+static osn_ip_addr_t test_ip(const char *str)
+{
+    osn_ip_addr_t ip;
+
+    if (!osn_ip_addr_from_str(&ip, str)) memset(&ip, 0, sizeof(ip));
+
+    return ip;
+}
+
+// Server i hands out 10.i.0.1 - 10.i.255.254
+static void test_servers_create(void)
+{
+    char ifname[C_IFNAME_LEN];
+    char start[C_IP4ADDR_LEN];
+    char stop[C_IP4ADDR_LEN];
+    int i;
+
+    memset(g_notified, 0, sizeof(g_notified));
+
+    for (i = 0; i < TEST_SERVERS; i++)
+    {
+        snprintf(ifname, sizeof(ifname), "br-test%d", i);
+        snprintf(start, sizeof(start), "10.%d.0.1", i);
+        snprintf(stop, sizeof(stop), "10.%d.255.254", i);
+
+        g_ds[i] = osn_dhcp_server_new(ifname);
+        osn_dhcp_server_range_add(g_ds[i], test_ip(start), test_ip(stop));
+        osn_dhcp_server_status_notify(g_ds[i], test_status_cb);
+    }
+}
+
+static void test_servers_delete(void)
+{
+    int i;
+
+    for (i = 0; i < TEST_SERVERS; i++)
+    {
+        osn_dhcp_server_del(g_ds[i]);
+        g_ds[i] = NULL;
+    }
+}
+
+/*
+ * Lease n belongs to server n % TEST_SERVERS. The whole file is rewritten on
+ * every change, as dnsmasq does; a non-zero g_rev[n] is appended to the
+ * hostname of lease n and expiry is added to every expiry time.
+ */
+static void test_leases_write(int num, int skip, int expiry)
+{
+    FILE *f;
+    int k;
+    int n;
+
+    f = fopen(g_leases_path, "w");
+    if (f == NULL)
+    {
+        printf("  fopen(%s) failed, errno = %d\n", g_leases_path, errno);
+        exit(1);
+    }
+
+    for (n = 0; n < num; n++)
+    {
+        if (n == skip) continue;
+
+        k = n / TEST_SERVERS + 1;
+        fprintf(f, "%d 02:00:00:%02x:%02x:%02x 10.%d.%d.%d host-%d",
+                1600000000 + n + expiry,
+                (n >> 16) & 0xff, (n >> 8) & 0xff, n & 0xff,
+                n % TEST_SERVERS, (k >> 8) & 0xff, k & 0xff,
+                n);
+        if (n < TEST_POOL_LEASES_MAX && g_rev[n] > 0) fprintf(f, "-rev%d", g_rev[n]);
+        fprintf(f, " 1,3,6,15,28 \"*\" 01:02:00:00:%02x:%02x:%02x\n",
+                (n >> 16) & 0xff, (n >> 8) & 0xff, n & 0xff);
+    }
+
+    fclose(f);
+}
+
+static uint64_t test_update(void)
+{
+    uint64_t start;
+
+    memset(g_notified, 0, sizeof(g_notified));
+
+    start = test_time_ns();
+    dhcp_lease_update(true);
+
+    return test_time_ns() - start;
+}
+
+// Reload as osn_dhcps.c did before change detection
+static void test_full_reload(void)
+{
+    osn_dhcp_server_t *ds;
+
+    ds_dlist_foreach(&dhcp_server_list, ds)
+    {
+        dhcp_lease_clear(ds);
+    }
+
+    dhcp_lease_parse();
+    dhcp_server_status_dispatch();
+}
+
+/*
+ * The regular expression lease parser osn_dhcps.c used before the tokenizer,
+ * kept as the reference for the parse test
+ */
+static void test_regex_cpy(char *dst, size_t sz, const char *line, regmatch_t rm)
+{
+    size_t len = rm.rm_eo - rm.rm_so;
+
+    if (len >= sz) len = sz - 1;
+    memcpy(dst, line + rm.rm_so, len);
+    dst[len] = '\0';
+}
+
+static bool test_regex_parse_line(struct osn_dhcp_server_lease *dl, const char *line)
+{
+    static const char dnsmasq_lease_parse_re[] =
+        "(^[0-9]+) "                            /* 1: Match timestamp */
+        "(([a-fA-F0-9]{2}:?){6}) "              /* 2,3: Match MAC address */
+        "(([0-9]+\\.?){4}) "                    /* 4,5: Match IP address */
+        "(\\*|[a-zA-Z0-9_-]+) "                 /* 6: Match hostname, can be "*" */
+        "(\\*|([0-9]+,?)+) "                    /* 7,8: Match fingerprint, can be "*" */
+        "\"(\\*|[^\"]+)\" "                     /* 9: Match vendor-class, can be "*" */
+        "[^ ]+$";                               /* Match CID, can be "*" */
+
+    static bool parse_re_compiled = false;
+    static regex_t parse_re;
+
+    char sleasetime[C_INT32_LEN];
+    char shwaddr[C_MACADDR_LEN];
+    char sipaddr[C_IP4ADDR_LEN];
+
+    regmatch_t rm[10];
+
+    if (!parse_re_compiled && regcomp(&parse_re, dnsmasq_lease_parse_re, REG_EXTENDED) != 0)
+    {
+        return false;
+    }
+
+    parse_re_compiled = true;
+
+    if (regexec(&parse_re, line, ARRAY_LEN(rm), rm, 0) != 0) return false;
+
+    memset(dl, 0, sizeof(*dl));
+
+    test_regex_cpy(sleasetime, sizeof(sleasetime), line, rm[1]);
+    test_regex_cpy(shwaddr, sizeof(shwaddr), line, rm[2]);
+    test_regex_cpy(sipaddr, sizeof(sipaddr), line, rm[4]);
+    test_regex_cpy(dl->dl_hostname, sizeof(dl->dl_hostname), line, rm[6]);
+    test_regex_cpy(dl->dl_fingerprint, sizeof(dl->dl_fingerprint), line, rm[7]);
+    test_regex_cpy(dl->dl_vendorclass, sizeof(dl->dl_vendorclass), line, rm[9]);
+
+    dl->dl_leasetime = strtod(sleasetime, NULL);
+
+    if (!osn_mac_addr_from_str(&dl->dl_hwaddr, shwaddr)) return false;
+    if (!osn_ip_addr_from_str(&dl->dl_ipaddr, sipaddr)) return false;
+
+    return true;
+}
+
+static bool test_lease_eq(const struct osn_dhcp_server_lease *a, const struct osn_dhcp_server_lease *b)
+{
+    return memcmp(&a->dl_hwaddr, &b->dl_hwaddr, sizeof(a->dl_hwaddr)) == 0 &&
+           osn_ip_addr_cmp(&a->dl_ipaddr, &b->dl_ipaddr) == 0 &&
+           strcmp(a->dl_hostname, b->dl_hostname) == 0 &&
+           strcmp(a->dl_fingerprint, b->dl_fingerprint) == 0 &&
+           strcmp(a->dl_vendorclass, b->dl_vendorclass) == 0 &&
+           a->dl_leasetime == b->dl_leasetime;
+}
+
+// Lease line n of a generated file, cycling through "*" and optional fields
+static void test_lease_line(char *line, size_t sz, int n)
+{
+    static const char *hostnames[] = { "*", "android-c992b284e24fdd69", "DESKTOP-4F2_X", "iPhone" };
+    static const char *fingerprints[] = { "*", "1,33,3,6,15,28,51,58,59", "1,3,6,15,119,252", "1,3,6," };
+    static const char *vendorclasses[] = { "*", "android-dhcp-11", "MSFT 5.0", "udhcp 1.31.1" };
+
+    snprintf(line, sz, "%d %02x:%02X:%02x:%02x:%02x:%02x 192.168.%d.%d %s %s \"%s\" %s",
+             1600000000 + n,
+             0x02, (n >> 24) & 0xff, (n >> 16) & 0xff, (n >> 8) & 0xff, n & 0xff, 0xaa,
+             (n >> 8) & 0xff, n & 0xff,
+             hostnames[n % 4],
+             fingerprints[(n / 4) % 4],
+             vendorclasses[(n / 16) % 4],
+             (n % 3) ? "01:02:00:00:00:00:aa" : "*");
+}
+
+// Parse a line with both parsers; false if their results differ
+static bool test_parse_parity(const char *line, bool *valid)
+{
+    struct osn_dhcp_server_lease dl_re;
+    struct osn_dhcp_server_lease dl_tok;
+    char buf[TEST_LINE_LEN];
+    bool ok_re;
+    bool ok_tok;
+
+    STRSCPY(buf, line);
+    ok_re = test_regex_parse_line(&dl_re, line);
+    ok_tok = dhcp_server_lease_parse_line(&dl_tok, buf);
+
+    *valid = ok_tok;
+    if (ok_re != ok_tok) return false;
+
+    return !ok_re || test_lease_eq(&dl_re, &dl_tok);
+}
+
+/*****************************************************************************/
+/* Tests                                                                     */
+/*****************************************************************************/
+
+static void test_update_bench(void)
+{
+    uint64_t edit_ns = 0;
+    uint64_t renew_ns = 0;
+    uint64_t reload_ns = 0;
+    uint64_t start;
+    int reload_notified = 0;
+    int edit;
+    int i;
+
+    memset(g_rev, 0, sizeof(g_rev));
+    test_servers_create();
+
+    test_leases_write(TEST_UPDATE_LEASES, -1, 0);
+    test_update();
+    CHECK(g_notified[0] == 1 && g_notified[1] == 1);
+    CHECK(g_ds[0]->ds_status.ds_leases_len == TEST_UPDATE_LEASES / TEST_SERVERS);
+    CHECK(g_ds[1]->ds_status.ds_leases_len == TEST_UPDATE_LEASES / TEST_SERVERS);
+
+    // Unchanged file: nobody is notified
+    test_update();
+    CHECK(test_notified_total() == 0);
+
+    // Hostname of one lease changes: only its server is notified
+    for (i = 0; i < TEST_UPDATE_EDITS; i++)
+    {
+        edit = (i * 37) % TEST_UPDATE_LEASES;
+        g_rev[edit]++;
+        test_leases_write(TEST_UPDATE_LEASES, -1, 0);
+        edit_ns += test_update();
+        CHECK(g_notified[edit % TEST_SERVERS] == 1);
+        CHECK(test_notified_total() == 1);
+    }
+
+    // Renewals only move the expiry time, which is not a change
+    for (i = 0; i < TEST_UPDATE_EDITS; i++)
+    {
+        test_leases_write(TEST_UPDATE_LEASES, -1, i + 1);
+        renew_ns += test_update();
+        CHECK(test_notified_total() == 0);
+    }
+
+    // A lease is released and handed out again
+    test_leases_write(TEST_UPDATE_LEASES, 1, 0);
+    test_update();
+    CHECK(g_notified[1] == 1 && g_notified[0] == 0);
+    CHECK(g_ds[1]->ds_status.ds_leases_len == TEST_UPDATE_LEASES / TEST_SERVERS - 1);
+
+    test_leases_write(TEST_UPDATE_LEASES, -1, 0);
+    test_update();
+    CHECK(g_notified[1] == 1 && g_notified[0] == 0);
+    CHECK(g_ds[1]->ds_status.ds_leases_len == TEST_UPDATE_LEASES / TEST_SERVERS);
+
+    // Full reload for comparison: clear, parse, notify every server
+    for (i = 0; i < TEST_UPDATE_EDITS; i++)
+    {
+        edit = (i * 37) % TEST_UPDATE_LEASES;
+        g_rev[edit]++;
+        test_leases_write(TEST_UPDATE_LEASES, -1, 0);
+        memset(g_notified, 0, sizeof(g_notified));
+
+        start = test_time_ns();
+        test_full_reload();
+        reload_ns += test_time_ns() - start;
+        reload_notified += test_notified_total();
+    }
+    CHECK(reload_notified == TEST_UPDATE_EDITS * TEST_SERVERS);
+
+    // A range change that moves no lease: the re-init debounce notifies nobody
+    osn_dhcp_server_range_add(g_ds[1], test_ip("10.9.0.1"), test_ip("10.9.0.100"));
+    memset(g_notified, 0, sizeof(g_notified));
+    dhcp_lease_init(EV_DEFAULT, &dhcp_lease_init_debounce, 0);
+    CHECK(test_notified_total() == 0);
+
+    // Server 0 loses its range and with it its leases, server 1 keeps its own
+    osn_dhcp_server_range_del(g_ds[0], test_ip("10.0.0.1"), test_ip("10.0.255.254"));
+    memset(g_notified, 0, sizeof(g_notified));
+    dhcp_lease_init(EV_DEFAULT, &dhcp_lease_init_debounce, 0);
+    CHECK(g_notified[0] == 1 && g_notified[1] == 0);
+    CHECK(g_ds[0]->ds_status.ds_leases_len == 0);
+    CHECK(g_ds[1]->ds_status.ds_leases_len == TEST_UPDATE_LEASES / TEST_SERVERS);
+
+    printf("  %d leases, per single-lease edit: update %.1f us (1 notification), "
+           "renewal %.1f us (0), full reload %.1f us (%d)\n",
+           TEST_UPDATE_LEASES,
+           edit_ns / 1e3 / TEST_UPDATE_EDITS,
+           renew_ns / 1e3 / TEST_UPDATE_EDITS,
+           reload_ns / 1e3 / TEST_UPDATE_EDITS,
+           TEST_SERVERS);
+
+    test_servers_delete();
+}
+
+static void test_parse(void)
+{
+    static const char *malformed[] =
+    {
+        "",
+        "1600000000",
+        "1600000000 02:00:00:00:00:01 192.168.1.2 host 1,3,6 \"*\"",
+        "16000000x0 02:00:00:00:00:01 192.168.1.2 host 1,3,6 \"*\" *",
+        "1600000000 02:00:00:00:00:0g 192.168.1.2 host 1,3,6 \"*\" *",
+        "1600000000 02-00-00-00-00-01 192.168.1.2 host 1,3,6 \"*\" *",
+        "1600000000 02:00:00:00:00 192.168.1.2 host 1,3,6 \"*\" *",
+        "1600000000 02:00:00:00:00:01 192.168.1.2/24 host 1,3,6 \"*\" *",
+        "1600000000 02:00:00:00:00:01 192.168.1.256 host 1,3,6 \"*\" *",
+        "1600000000 02:00:00:00:00:01 fe80::1 host 1,3,6 \"*\" *",
+        "1600000000 02:00:00:00:00:01 192.168.1.2 host.lan 1,3,6 \"*\" *",
+        "1600000000 02:00:00:00:00:01 192.168.1.2 ** 1,3,6 \"*\" *",
+        "1600000000 02:00:00:00:00:01 192.168.1.2 host ,1,3 \"*\" *",
+        "1600000000 02:00:00:00:00:01 192.168.1.2 host 1,,3 \"*\" *",
+        "1600000000 02:00:00:00:00:01 192.168.1.2 host 1;3 \"*\" *",
+        "1600000000 02:00:00:00:00:01 192.168.1.2 host 1,3,6 \"\" *",
+        "1600000000 02:00:00:00:00:01 192.168.1.2 host 1,3,6 \"a\"b\" *",
+        "1600000000 02:00:00:00:00:01 192.168.1.2 host 1,3,6 \"open *",
+        "1600000000 02:00:00:00:00:01 192.168.1.2 host 1,3,6 \"*\"",
+        "1600000000 02:00:00:00:00:01 192.168.1.2 host 1,3,6 \"*\" * extra",
+        "1600000000 02:00:00:00:00:01 192.168.1.2 host \"*\" *",
+    };
+
+    /* Accepted by the tokenizer only: dnsmasq's own format and extra blanks */
+    static const char *tokenizer_only[] =
+    {
+        "1600000000 02:00:00:00:00:01 192.168.1.2 host 01:02:00:00:00:00:01",
+        "1600000000 02:00:00:00:00:01 192.168.1.2 * *",
+        "1600000000  02:00:00:00:00:01 192.168.1.2 host 1,3,6 \"*\" *",
+        "1600000000 02:00:00:00:00:01 192.168.1.2 host 1,3,6 \"*\" * ",
+    };
+
+    struct osn_dhcp_server_lease dl;
+    char (*lines)[TEST_LINE_LEN];
+    char tmp[TEST_LINE_LEN];
+    char *buf;
+    char *work;
+    char *line;
+    char *eol;
+    uint64_t regex_ns = 0;
+    uint64_t tok_ns = 0;
+    uint64_t start;
+    size_t len = 0;
+    int mismatch = 0;
+    int parsed;
+    bool valid;
+    int round;
+    int n;
+
+    log_severity_set(LOG_SEVERITY_DISABLED);
+
+    lines = MALLOC(TEST_PARSE_LINES * sizeof(*lines));
+    for (n = 0; n < TEST_PARSE_LINES; n++)
+    {
+        test_lease_line(lines[n], sizeof(lines[n]), n);
+        if (!test_parse_parity(lines[n], &valid) || !valid)
+        {
+            printf("  mismatch: %s\n", lines[n]);
+            mismatch++;
+        }
+        len += strlen(lines[n]) + 1;
+    }
+    CHECK(mismatch == 0);
+
+    for (n = 0; n < (int)ARRAY_SIZE(malformed); n++)
+    {
+        CHECK(test_parse_parity(malformed[n], &valid));
+        CHECK(!valid);
+    }
+
+    for (n = 0; n < (int)ARRAY_SIZE(tokenizer_only); n++)
+    {
+        CHECK(!test_regex_parse_line(&dl, tokenizer_only[n]));
+        STRSCPY(tmp, tokenizer_only[n]);
+        CHECK(dhcp_server_lease_parse_line(&dl, tmp));
+        CHECK(strcmp(dl.dl_hostname, n == 1 ? "*" : "host") == 0);
+    }
+
+    log_severity_set(LOG_SEVERITY_WARN);
+
+    // The file as a single buffer, as dhcp_lease_parse() reads it
+    buf = MALLOC(len + 1);
+    work = MALLOC(len + 1);
+    len = 0;
+    for (n = 0; n < TEST_PARSE_LINES; n++)
+    {
+        len += sprintf(buf + len, "%s\n", lines[n]);
+    }
+
+    for (round = 0; round < TEST_PARSE_ROUNDS; round++)
+    {
+        parsed = 0;
+        start = test_time_ns();
+        for (n = 0; n < TEST_PARSE_LINES; n++)
+        {
+            if (test_regex_parse_line(&dl, lines[n])) parsed++;
+        }
+        regex_ns += test_time_ns() - start;
+        CHECK(parsed == TEST_PARSE_LINES);
+
+        // Each round tokenizes a fresh copy, the tokenizer splits it in place
+        memcpy(work, buf, len + 1);
+
+        parsed = 0;
+        start = test_time_ns();
+        for (line = work; line < work + len; line = eol + 1)
+        {
+            eol = strchr(line, '\n');
+            *eol = '\0';
+            if (dhcp_server_lease_parse_line(&dl, line)) parsed++;
+        }
+        tok_ns += test_time_ns() - start;
+        CHECK(parsed == TEST_PARSE_LINES);
+    }
+
+    printf("  %d lines: regex %.0f ns/line, tokenizer %.0f ns/line\n",
+           TEST_PARSE_LINES,
+           (double)regex_ns / TEST_PARSE_ROUNDS / TEST_PARSE_LINES,
+           (double)tok_ns / TEST_PARSE_ROUNDS / TEST_PARSE_LINES);
+
+    FREE(work);
+    FREE(buf);
+    FREE(lines);
+}
+
+static void test_changed(void)
+{
+    struct osn_dhcp_server_lease a;
+    struct osn_dhcp_server_lease b;
+
+    memset(&a, 0, sizeof(a));
+    osn_mac_addr_from_str(&a.dl_hwaddr, "02:00:00:00:00:01");
+    a.dl_ipaddr = test_ip("10.0.0.2");
+    STRSCPY(a.dl_hostname, "host");
+    STRSCPY(a.dl_fingerprint, "1,3,6");
+    STRSCPY(a.dl_vendorclass, "*");
+    a.dl_leasetime = 1600000000;
+
+    // Same lease with a new lease time and stale bytes after each string
+    memset(&b, 0xa5, sizeof(b));
+    b.dl_hwaddr = a.dl_hwaddr;
+    b.dl_ipaddr = a.dl_ipaddr;
+    strcpy(b.dl_hostname, a.dl_hostname);
+    strcpy(b.dl_fingerprint, a.dl_fingerprint);
+    strcpy(b.dl_vendorclass, a.dl_vendorclass);
+    b.dl_leasetime = a.dl_leasetime + 3600;
+    CHECK(!dhcp_lease_changed(&a, &b));
+
+    STRSCPY(b.dl_hostname, "host2");
+    CHECK(dhcp_lease_changed(&a, &b));
+    STRSCPY(b.dl_hostname, a.dl_hostname);
+
+    STRSCPY(b.dl_fingerprint, "1,3,6,15");
+    CHECK(dhcp_lease_changed(&a, &b));
+    STRSCPY(b.dl_fingerprint, a.dl_fingerprint);
+
+    STRSCPY(b.dl_vendorclass, "MSFT 5.0");
+    CHECK(dhcp_lease_changed(&a, &b));
+    STRSCPY(b.dl_vendorclass, a.dl_vendorclass);
+
+    CHECK(!dhcp_lease_changed(&a, &b));
+}
+
+static void test_pool(void)
+{
+    static const int sizes[] = { 1000, 5000, 20000 };
+
+    osn_dhcp_server_t *ds;
+    size_t lease_sz = sizeof(struct osn_dhcp_server_lease);
+    size_t pool;
+    size_t index;
+    int cap;
+    int i;
+
+    memset(g_rev, 0, sizeof(g_rev));
+    test_servers_create();
+    ds = g_ds[0];
+
+    printf("  sizeof(struct osn_dhcp_server_lease) = %zu\n", lease_sz);
+
+    for (i = 0; i < (int)ARRAY_SIZE(sizes); i++)
+    {
+        // All leases on the first server
+        test_leases_write(sizes[i] * TEST_SERVERS, -1, 0);
+        test_update();
+        CHECK(ds->ds_status.ds_leases_len == sizes[i]);
+
+        for (cap = DHCP_LEASE_RESIZE_QUANTUM; cap < sizes[i]; cap *= 2);
+        CHECK(ds->ds_leases_cap == cap);
+
+        pool = (size_t)ds->ds_leases_cap * lease_sz;
+        index = (size_t)ds->ds_leases_cap * 2 * sizeof(int32_t);
+
+        // During an update the previous snapshot and the new pool coexist
+        printf("  %5d leases: pool %d entries, %zu KiB pool + %zu KiB index = %.0f B/lease, "
+               "%zu KiB peak during update\n",
+               sizes[i],
+               ds->ds_leases_cap,
+               pool / 1024,
+               index / 1024,
+               (double)(pool + index) / sizes[i],
+               (2 * pool + index) / 1024);
+    }
+
+    // Most leases released: the pool shrinks back
+    test_leases_write(TEST_SERVERS * 100, -1, 0);
+    test_update();
+    CHECK(ds->ds_status.ds_leases_len == 100);
+    CHECK(ds->ds_leases_cap == 256);
+
+    test_servers_delete();
+}
+
+static void test_route_write(const char **addrs, int num)
+{
+    FILE *f;
+    int n;
+
+    f = fopen(g_leases_path, "w");
+    if (f == NULL) return;
+
+    for (n = 0; n < num; n++)
+    {
+        fprintf(f, "1600000000 02:00:00:00:01:%02x %s host-%d * \"*\" *\n", n, addrs[n], n);
+    }
+
+    fclose(f);
+}
+
+static void test_route(void)
+{
+    static const char *addrs[] =
+    {
+        "127.0.0.150",      // range of lo
+        "127.0.0.5",        // subnet of lo, outside its range (static lease)
+        "10.1.0.5",         // range of br-test1
+        "10.2.0.5",         // no range, no subnet
+    };
+
+    osn_dhcp_server_t *ds_lo;
+    osn_dhcp_server_t *ds;
+
+    memset(g_notified, 0, sizeof(g_notified));
+
+    ds_lo = osn_dhcp_server_new("lo");
+    osn_dhcp_server_range_add(ds_lo, test_ip("127.0.0.100"), test_ip("127.0.0.200"));
+
+    ds = osn_dhcp_server_new("br-test1");
+    osn_dhcp_server_range_add(ds, test_ip("10.1.0.1"), test_ip("10.1.255.254"));
+
+    test_route_write(addrs, ARRAY_SIZE(addrs));
+    test_update();
+    CHECK(ds_lo->ds_status.ds_leases_len == 2);
+    CHECK(ds->ds_status.ds_leases_len == 1);
+
+    // A single server owns every lease, whatever its ranges
+    osn_dhcp_server_del(ds_lo);
+    test_update();
+    CHECK(ds->ds_status.ds_leases_len == (int)ARRAY_SIZE(addrs));
+
+    osn_dhcp_server_del(ds);
+}
+
+// Does dir/name hold exactly expect? A NULL expect means no such file.
+static bool test_file_eq(const char *dir, const char *name, const char *expect)
+{
+    char path[C_MAXPATH_LEN];
+    char buf[1024];
+    size_t len;
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    f = fopen(path, "r");
+    if (f == NULL) return expect == NULL;
+
+    len = fread(buf, 1, sizeof(buf) - 1, f);
+    buf[len] = '\0';
+    fclose(f);
+
+    return expect != NULL && strcmp(buf, expect) == 0;
+}
+
+static void test_resv_line(char *buf, size_t sz, osn_mac_addr_t mac, const char *ip, const char *hostname)
+{
+    osn_ip_addr_t ipaddr = test_ip(ip);
+    size_t len = strlen(buf);
+
+    snprintf(buf + len, sz - len, PRI_osn_mac_addr","PRI_osn_ip_addr"%s%s\n",
+             FMT_osn_mac_addr(mac),
+             FMT_osn_ip_addr(ipaddr),
+             hostname != NULL ? "," : "",
+             hostname != NULL ? hostname : "");
+}
+
+static void test_conf(void)
+{
+    osn_dhcp_server_t *ds;
+    osn_mac_addr_t mac[3];
+    char expect[512];
+    FILE *f;
+
+    f = fopen(g_pid_path, "w");
+    if (f == NULL) return;
+    fprintf(f, "%d\n", (int)getpid());
+    fclose(f);
+    g_reloads = 0;
+
+    osn_mac_addr_from_str(&mac[0], "02:00:00:00:00:01");
+    osn_mac_addr_from_str(&mac[1], "02:00:00:00:00:02");
+    osn_mac_addr_from_str(&mac[2], "02:00:00:00:00:03");
+
+    ds = osn_dhcp_server_new("br-test0");
+
+    CHECK(osn_dhcp_server_reservation_add(ds, mac[0], test_ip("10.0.0.10"), "printer"));
+    CHECK(osn_dhcp_server_reservation_add(ds, mac[1], test_ip("10.0.0.11"), NULL));
+    CHECK(osn_dhcp_server_option_set(ds, DHCP_OPTION_ROUTER, "10.0.0.1"));
+    CHECK(osn_dhcp_server_option_set(ds, DHCP_OPTION_DNS_SERVERS, "10.0.0.1,8.8.8.8"));
+    CHECK(!osn_dhcp_server_option_set(ds, 0, "x"));
+    CHECK(osn_dhcp_server_apply(ds));
+    CHECK(g_reloads == 1);
+
+    expect[0] = '\0';
+    test_resv_line(expect, sizeof(expect), mac[0], "10.0.0.10", "printer");
+    test_resv_line(expect, sizeof(expect), mac[1], "10.0.0.11", NULL);
+    CHECK(test_file_eq(g_hosts_dir, "br-test0", expect));
+    CHECK(test_file_eq(g_opts_dir, "br-test0",
+                       "tag:br-test0,3,10.0.0.1\n"
+                       "tag:br-test0,6,10.0.0.1,8.8.8.8\n"));
+
+    // Nothing changed, the same values again, or removed and added back: no reload
+    CHECK(osn_dhcp_server_apply(ds));
+    CHECK(osn_dhcp_server_reservation_add(ds, mac[0], test_ip("10.0.0.10"), "printer"));
+    CHECK(osn_dhcp_server_option_set(ds, DHCP_OPTION_ROUTER, "10.0.0.1"));
+    CHECK(osn_dhcp_server_apply(ds));
+    CHECK(osn_dhcp_server_reservation_del(ds, mac[1]));
+    CHECK(osn_dhcp_server_reservation_add(ds, mac[1], test_ip("10.0.0.11"), NULL));
+    CHECK(osn_dhcp_server_apply(ds));
+    CHECK(g_reloads == 1);
+    CHECK(test_file_eq(g_hosts_dir, "br-test0", expect));
+
+    // An address reserved for another client moves to it
+    CHECK(osn_dhcp_server_reservation_add(ds, mac[2], test_ip("10.0.0.10"), "printer2"));
+    CHECK(osn_dhcp_server_apply(ds));
+    CHECK(g_reloads == 2);
+
+    expect[0] = '\0';
+    test_resv_line(expect, sizeof(expect), mac[1], "10.0.0.11", NULL);
+    test_resv_line(expect, sizeof(expect), mac[2], "10.0.0.10", "printer2");
+    CHECK(test_file_eq(g_hosts_dir, "br-test0", expect));
+
+    // Only the options file changes
+    CHECK(osn_dhcp_server_option_set(ds, DHCP_OPTION_ROUTER, NULL));
+    CHECK(osn_dhcp_server_apply(ds));
+    CHECK(g_reloads == 3);
+    CHECK(test_file_eq(g_opts_dir, "br-test0", "tag:br-test0,6,10.0.0.1,8.8.8.8\n"));
+    CHECK(test_file_eq(g_hosts_dir, "br-test0", expect));
+
+    // dnsmasq not running: files are still written
+    unlink(g_pid_path);
+    CHECK(osn_dhcp_server_option_set(ds, DHCP_OPTION_ROUTER, "10.0.0.254"));
+    CHECK(osn_dhcp_server_apply(ds));
+    CHECK(g_reloads == 3);
+    CHECK(test_file_eq(g_opts_dir, "br-test0",
+                       "tag:br-test0,3,10.0.0.254\n"
+                       "tag:br-test0,6,10.0.0.1,8.8.8.8\n"));
+
+    // Deleting the server removes its files
+    f = fopen(g_pid_path, "w");
+    if (f != NULL)
+    {
+        fprintf(f, "%d\n", (int)getpid());
+        fclose(f);
+    }
+
+    osn_dhcp_server_del(ds);
+    CHECK(g_reloads == 4);
+    CHECK(test_file_eq(g_hosts_dir, "br-test0", NULL));
+    CHECK(test_file_eq(g_opts_dir, "br-test0", NULL));
+
+    unlink(g_pid_path);
+}
+
+/*****************************************************************************/
+
+static const struct
+{
+    const char                 *name;
+    void                      (*fn)(void);
+} g_tests[] =
+{
+    { "update",         test_update_bench },
+    { "parse",          test_parse },
+    { "changed",        test_changed },
+    { "pool",           test_pool },
+    { "route",          test_route },
+    { "conf",           test_conf },
+};
+
+int main(int argc, char **argv)
+{
+    bool run;
+    size_t t;
+    int a;
+
+    log_open("DHCP_TEST", LOG_OPEN_STDOUT);
+    log_severity_set(LOG_SEVERITY_WARN);
+
+    if (mkdtemp(g_dir) == NULL)
+    {
+        printf("mkdtemp(%s) failed, errno = %d\n", g_dir, errno);
+        return 1;
+    }
+
+    snprintf(g_leases_path, sizeof(g_leases_path), "%s/dnsmasq.leases", g_dir);
+    snprintf(g_hosts_dir, sizeof(g_hosts_dir), "%s/hosts.d", g_dir);
+    snprintf(g_opts_dir, sizeof(g_opts_dir), "%s/opts.d", g_dir);
+    snprintf(g_pid_path, sizeof(g_pid_path), "%s/dnsmasq.pid", g_dir);
+
+    dhcp_leases_path = g_leases_path;
+    dhcp_hosts_dir = g_hosts_dir;
+    dhcp_opts_dir = g_opts_dir;
+    dhcp_pid_path = g_pid_path;
+
+    signal(SIGHUP, test_sighup);
+
+    for (t = 0; t < ARRAY_SIZE(g_tests); t++)
+    {
+        run = (argc < 2);
+        for (a = 1; a < argc; a++)
+        {
+            if (!strcmp(argv[a], g_tests[t].name)) run = true;
+        }
+        if (!run) continue;
+
+        printf("%s\n", g_tests[t].name);
+        g_tests[t].fn();
+    }
+
+    unlink(g_leases_path);
+    rmdir(g_hosts_dir);
+    rmdir(g_opts_dir);
+    rmdir(g_dir);
+
+    printf("%s\n", g_failed ? "FAILED" : "PASSED");
+    return g_failed ? 1 : 0;
+}
@@ -0,0 +1,623 @@
+/*
+Copyright (c) 2021, Plume Design Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+   3. Neither the name of the Plume Design Inc. nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Plume Design Inc. BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * MeshSync agent simulator
+ *
+ * Plays the role of the RDK mesh agent: listens on the MeshSync UNIX socket,
+ * waits for the OpenSync sync client to connect, sends it a scripted or
+ * built-in sequence of MeshSync messages and counts the messages OpenSync
+ * sends back.
+ *
+ * Everything is measured on the agent side of the socket: send rate, inbound
+ * message counts per type and the gap between the last message sent and the
+ * next message received. It does not see the sync client's outbound queue,
+ * so it cannot tell a message coalesced by OpenSync from one dropped, nor
+ * time a message from sync_send_msg() to the socket; those are covered by
+ * the sync_test tool and by the counters the target logs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <errno.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <mesh/meshsync_msgs.h>  // this file is included by vendor
+
+#define LOG(...) printf("MESHSYNCSIM: "  __VA_ARGS__)
+#define ERR(...) fprintf(stderr, "MESHSYNCSIM: " __VA_ARGS__)
+
+#define MAX_LINE_LEN        512
+#define MAX_ARGS            8
+#define MSG_TYPE_MAX        64
+
+typedef struct
+{
+    const char  *sock_path;
+    const char  *script;
+    const char  *builtin;
+    int          count;         // built-in sequence size
+    int          interval_ms;   // delay between scripted messages
+    int          read_delay_ms; // slow reader: delay before each recv()
+    int          linger_ms;     // keep reading after the sequence is sent
+    int          expected;      // messages expected back from OpenSync
+    bool         verbose;
+} sim_opts_t;
+
+typedef struct
+{
+    // Sent to OpenSync
+    uint64_t    tx_msgs;
+    uint64_t    tx_us;          // time spent in write()
+    uint64_t    seq_start_us;
+    uint64_t    seq_end_us;
+
+    // Received from OpenSync
+    uint64_t    rx_msgs;
+    uint64_t    rx_by_type[MSG_TYPE_MAX];
+    uint64_t    rx_first_us;
+    uint64_t    rx_last_us;
+    uint8_t     rx_buf[sizeof(MeshSync)];
+    size_t      rx_len;
+
+    // Time from the last message sent to the next message received
+    uint64_t    last_tx_us;
+    bool        waiting_reply;
+    uint64_t    lat_num;
+    uint64_t    lat_sum_us;
+    uint64_t    lat_min_us;
+    uint64_t    lat_max_us;
+} sim_stats_t;
+
+static sim_opts_t   g_opts =
+{
+    .sock_path = MESH_SOCKET_PATH_NAME,
+    .count = 32,
+    .interval_ms = 0,
+    .read_delay_ms = 0,
+    .linger_ms = 2000,
+    .expected = -1,
+};
+
+static sim_stats_t  g_stats;
+static int          g_client_fd = -1;
+static volatile sig_atomic_t g_stop;
+
+/*****************************************************************************/
+
+static uint64_t sim_time_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static void sim_sig_handler(int sig)
+{
+    (void)sig;
+    g_stop = 1;
+}
+
+static void sim_set_addr(struct sockaddr_un *addr, const char *path)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+
+    if (*path == '\0')
+    {
+        // Abstract socket name
+        strncpy(addr->sun_path + 1, path + 1, sizeof(addr->sun_path) - 2);
+    }
+    else
+    {
+        strncpy(addr->sun_path, path, sizeof(addr->sun_path) - 1);
+        unlink(path);
+    }
+}
+
+/*****************************************************************************/
+
+static void sim_rx_msg(const MeshSync *mp)
+{
+    uint64_t now = sim_time_us();
+    uint64_t lat;
+
+    g_stats.rx_msgs++;
+    if (g_stats.rx_first_us == 0) g_stats.rx_first_us = now;
+    g_stats.rx_last_us = now;
+
+    if ((unsigned)mp->msgType < MSG_TYPE_MAX) g_stats.rx_by_type[mp->msgType]++;
+
+    if (g_stats.waiting_reply)
+    {
+        lat = now - g_stats.last_tx_us;
+        g_stats.waiting_reply = false;
+        g_stats.lat_num++;
+        g_stats.lat_sum_us += lat;
+        if (g_stats.lat_min_us == 0 || lat < g_stats.lat_min_us) g_stats.lat_min_us = lat;
+        if (lat > g_stats.lat_max_us) g_stats.lat_max_us = lat;
+    }
+
+    if (g_opts.verbose) LOG("<- msg type %d\n", mp->msgType);
+}
+
+// Read whatever is available; false when the peer went away
+static bool sim_rx(void)
+{
+    MeshSync msg;
+    ssize_t ret;
+
+    if (g_opts.read_delay_ms > 0) usleep(g_opts.read_delay_ms * 1000);
+
+    ret = recv(g_client_fd, g_stats.rx_buf + g_stats.rx_len,
+               sizeof(g_stats.rx_buf) - g_stats.rx_len, MSG_DONTWAIT);
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return true;
+    if (ret <= 0)
+    {
+        LOG("OpenSync disconnected\n");
+        return false;
+    }
+
+    g_stats.rx_len += ret;
+    if (g_stats.rx_len == sizeof(MeshSync))
+    {
+        memcpy(&msg, g_stats.rx_buf, sizeof(msg));
+        g_stats.rx_len = 0;
+        sim_rx_msg(&msg);
+    }
+
+    return true;
+}
+
+// Serve inbound messages for timeout_ms; false when the peer went away
+static bool sim_poll(int timeout_ms)
+{
+    struct pollfd pfd;
+    uint64_t end = sim_time_us() + (uint64_t)timeout_ms * 1000;
+    int64_t left;
+
+    do
+    {
+        left = (int64_t)(end - sim_time_us()) / 1000;
+        if (left < 0) left = 0;
+
+        pfd.fd = g_client_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        if (poll(&pfd, 1, (int)left) > 0)
+        {
+            if (pfd.revents & (POLLERR | POLLHUP) && !(pfd.revents & POLLIN)) return false;
+            if (!sim_rx()) return false;
+        }
+    } while (!g_stop && sim_time_us() < end);
+
+    return true;
+}
+
+static bool sim_tx(const MeshSync *mp)
+{
+    const uint8_t *data = (const uint8_t *)mp;
+    size_t off = 0;
+    uint64_t start = sim_time_us();
+    ssize_t ret;
+
+    while (off < sizeof(*mp))
+    {
+        ret = send(g_client_fd, data + off, sizeof(*mp) - off, MSG_NOSIGNAL);
+        if (ret < 0 && errno == EINTR) continue;
+        if (ret <= 0)
+        {
+            ERR("send failed, errno = %d\n", errno);
+            return false;
+        }
+        off += ret;
+    }
+
+    g_stats.last_tx_us = sim_time_us();
+    g_stats.tx_us += g_stats.last_tx_us - start;
+    g_stats.tx_msgs++;
+    g_stats.waiting_reply = true;
+
+    if (g_opts.verbose) LOG("-> msg type %d\n", mp->msgType);
+
+    // Drain replies without blocking so a slow OpenSync reader shows up as
+    // write time, not as a full socket on our side
+    return sim_poll(g_opts.interval_ms);
+}
+
+/*****************************************************************************/
+
+static void msg_channel(MeshSync *mp, int radio, int channel)
+{
+    memset(mp, 0, sizeof(*mp));
+    mp->msgType = MESH_WIFI_RADIO_CHANNEL;
+    mp->data.wifiRadioChannel.index = radio;
+    mp->data.wifiRadioChannel.channel = channel;
+}
+
+static void msg_channel_bw(MeshSync *mp, int radio, int bw)
+{
+    memset(mp, 0, sizeof(*mp));
+    mp->msgType = MESH_WIFI_RADIO_CHANNEL_BW;
+    mp->data.wifiRadioChannelBw.index = radio;
+    mp->data.wifiRadioChannelBw.bw = bw;
+}
+
+static void msg_ssid(MeshSync *mp, int vap, const char *ssid)
+{
+    memset(mp, 0, sizeof(*mp));
+    mp->msgType = MESH_WIFI_SSID_NAME;
+    mp->data.wifiSSIDName.index = vap;
+    snprintf(mp->data.wifiSSIDName.ssid, sizeof(mp->data.wifiSSIDName.ssid), "%s", ssid);
+}
+
+static void msg_advertise(MeshSync *mp, int vap, int enable)
+{
+    memset(mp, 0, sizeof(*mp));
+    mp->msgType = MESH_WIFI_SSID_ADVERTISE;
+    mp->data.wifiSSIDAdvertise.index = vap;
+    mp->data.wifiSSIDAdvertise.enable = enable ? true : false;
+}
+
+static void msg_security(MeshSync *mp, int vap, const char *sec, const char *enc, const char *pass)
+{
+    memset(mp, 0, sizeof(*mp));
+    mp->msgType = MESH_WIFI_AP_SECURITY;
+    mp->data.wifiAPSecurity.index = vap;
+    snprintf(mp->data.wifiAPSecurity.secMode, sizeof(mp->data.wifiAPSecurity.secMode), "%s", sec);
+    snprintf(mp->data.wifiAPSecurity.encryptMode, sizeof(mp->data.wifiAPSecurity.encryptMode), "%s", enc);
+    snprintf(mp->data.wifiAPSecurity.passphrase, sizeof(mp->data.wifiAPSecurity.passphrase), "%s", pass);
+}
+
+static void msg_client(MeshSync *mp, const char *mac, const char *host, bool connected)
+{
+    memset(mp, 0, sizeof(*mp));
+    mp->msgType = MESH_CLIENT_CONNECT;
+    mp->data.meshConnect.iface = MESH_IFACE_WIFI;
+    mp->data.meshConnect.isConnected = connected;
+    snprintf(mp->data.meshConnect.mac, sizeof(mp->data.meshConnect.mac), "%s", mac);
+    snprintf(mp->data.meshConnect.host, sizeof(mp->data.meshConnect.host), "%s", host);
+}
+
+static void msg_kick(MeshSync *mp, int vap, const char *mac)
+{
+    memset(mp, 0, sizeof(*mp));
+    mp->msgType = MESH_WIFI_AP_KICK_ASSOC_DEVICE;
+    mp->data.wifiAPKickAssocDevice.index = vap;
+    snprintf(mp->data.wifiAPKickAssocDevice.mac, sizeof(mp->data.wifiAPKickAssocDevice.mac), "%s", mac);
+}
+
+static void msg_reset(MeshSync *mp)
+{
+    memset(mp, 0, sizeof(*mp));
+    mp->msgType = MESH_WIFI_RESET;
+    mp->data.wifiReset.reset = true;
+}
+
+static void sim_mac(char *buf, size_t len, int n)
+{
+    snprintf(buf, len, "02:00:00:%02x:%02x:%02x", (n >> 16) & 0xff, (n >> 8) & 0xff, n & 0xff);
+}
+
+/*****************************************************************************/
+
+/*
+ * Script lines (# starts a comment):
+ *   channel <radio> <channel>
+ *   bw <radio> <MHz>
+ *   ssid <vap> <ssid>
+ *   advertise <vap> <0|1>
+ *   security <vap> <secMode> <encryptMode> <passphrase>
+ *   connect <mac> [host]
+ *   disconnect <mac> [host]
+ *   kick <vap> <mac>
+ *   reset
+ *   sleep <ms>
+ */
+static bool sim_script_line(char *line, int lineno)
+{
+    char *argv[MAX_ARGS];
+    int argc = 0;
+    char *tok;
+    char *save = NULL;
+    MeshSync msg;
+
+    for (tok = strtok_r(line, " \t\r\n", &save); tok && argc < MAX_ARGS; tok = strtok_r(NULL, " \t\r\n", &save))
+    {
+        if (*tok == '#') break;
+        argv[argc++] = tok;
+    }
+    if (argc == 0) return true;
+
+#define NEED(n) if (argc < (n) + 1) goto bad_args
+
+    if (!strcmp(argv[0], "channel"))            { NEED(2); msg_channel(&msg, atoi(argv[1]), atoi(argv[2])); }
+    else if (!strcmp(argv[0], "bw"))            { NEED(2); msg_channel_bw(&msg, atoi(argv[1]), atoi(argv[2])); }
+    else if (!strcmp(argv[0], "ssid"))          { NEED(2); msg_ssid(&msg, atoi(argv[1]), argv[2]); }
+    else if (!strcmp(argv[0], "advertise"))     { NEED(2); msg_advertise(&msg, atoi(argv[1]), atoi(argv[2])); }
+    else if (!strcmp(argv[0], "security"))      { NEED(4); msg_security(&msg, atoi(argv[1]), argv[2], argv[3], argv[4]); }
+    else if (!strcmp(argv[0], "connect"))       { NEED(1); msg_client(&msg, argv[1], argc > 2 ? argv[2] : "", true); }
+    else if (!strcmp(argv[0], "disconnect"))    { NEED(1); msg_client(&msg, argv[1], argc > 2 ? argv[2] : "", false); }
+    else if (!strcmp(argv[0], "kick"))          { NEED(2); msg_kick(&msg, atoi(argv[1]), argv[2]); }
+    else if (!strcmp(argv[0], "reset"))         { msg_reset(&msg); }
+    else if (!strcmp(argv[0], "sleep"))         { NEED(1); return sim_poll(atoi(argv[1])); }
+    else
+    {
+        ERR("line %d: unknown command '%s'\n", lineno, argv[0]);
+        return false;
+    }
+
+#undef NEED
+
+    return sim_tx(&msg);
+
+bad_args:
+    ERR("line %d: not enough arguments for '%s'\n", lineno, argv[0]);
+    return false;
+}
+
+static bool sim_run_script(const char *path)
+{
+    char line[MAX_LINE_LEN];
+    int lineno = 0;
+    bool ok = true;
+    FILE *f;
+
+    f = fopen(path, "r");
+    if (f == NULL)
+    {
+        ERR("cannot open script %s, errno = %d\n", path, errno);
+        return false;
+    }
+
+    while (ok && !g_stop && fgets(line, sizeof(line), f) != NULL)
+    {
+        ok = sim_script_line(line, ++lineno);
+    }
+
+    fclose(f);
+    return ok;
+}
+
+/*
+ * Built-in sequences:
+ *   replay   - config replay after reconnect: channel and bandwidth of 3
+ *              radios, SSID, advertise and security of <count> VAPs
+ *   channels - <count> channel changes alternating over 3 radios
+ *   storm    - <count> clients connecting, then all of them disconnecting
+ *   kicks    - <count> client kicks spread over 2 VAPs
+ */
+static bool sim_run_builtin(const char *name, int count)
+{
+    static const int channels[] = { 1, 6, 11, 36, 44, 149, 157 };
+    char mac[32];
+    char buf[64];
+    MeshSync msg;
+    int i;
+
+    if (!strcmp(name, "replay"))
+    {
+        for (i = 0; i < 3; i++)
+        {
+            msg_channel(&msg, i, channels[(i * 3) % 7]);
+            if (!sim_tx(&msg)) return false;
+            msg_channel_bw(&msg, i, i == 0 ? 20 : 80);
+            if (!sim_tx(&msg)) return false;
+        }
+        for (i = 0; i < count; i++)
+        {
+            snprintf(buf, sizeof(buf), "sim-ssid-%d", i);
+            msg_ssid(&msg, i, buf);
+            if (!sim_tx(&msg)) return false;
+            msg_advertise(&msg, i, 1);
+            if (!sim_tx(&msg)) return false;
+            msg_security(&msg, i, "WPA2-Personal", "AES", "simulator-psk");
+            if (!sim_tx(&msg)) return false;
+        }
+    }
+    else if (!strcmp(name, "channels"))
+    {
+        for (i = 0; i < count; i++)
+        {
+            msg_channel(&msg, i % 3, channels[i % 7]);
+            if (!sim_tx(&msg)) return false;
+        }
+    }
+    else if (!strcmp(name, "storm"))
+    {
+        for (i = 0; i < count; i++)
+        {
+            sim_mac(mac, sizeof(mac), i);
+            snprintf(buf, sizeof(buf), "sim-client-%d", i);
+            msg_client(&msg, mac, buf, true);
+            if (!sim_tx(&msg)) return false;
+        }
+        for (i = 0; i < count; i++)
+        {
+            sim_mac(mac, sizeof(mac), i);
+            snprintf(buf, sizeof(buf), "sim-client-%d", i);
+            msg_client(&msg, mac, buf, false);
+            if (!sim_tx(&msg)) return false;
+        }
+    }
+    else if (!strcmp(name, "kicks"))
+    {
+        for (i = 0; i < count; i++)
+        {
+            sim_mac(mac, sizeof(mac), i);
+            msg_kick(&msg, i % 2, mac);
+            if (!sim_tx(&msg)) return false;
+        }
+    }
+    else
+    {
+        ERR("unknown built-in sequence '%s'\n", name);
+        return false;
+    }
+
+    return true;
+}
+
+/*****************************************************************************/
+
+static void sim_report(void)
+{
+    uint64_t seq_us = g_stats.seq_end_us - g_stats.seq_start_us;
+    uint64_t rx_us = g_stats.rx_last_us - g_stats.rx_first_us;
+    int i;
+
+    LOG("sent: %llu msgs in %.3f s (%.0f msgs/s), %.1f us avg write\n",
+        (unsigned long long)g_stats.tx_msgs,
+        seq_us / 1e6,
+        seq_us ? g_stats.tx_msgs * 1e6 / seq_us : 0.0,
+        g_stats.tx_msgs ? (double)g_stats.tx_us / g_stats.tx_msgs : 0.0);
+
+    LOG("received: %llu msgs (%.0f msgs/s)\n",
+        (unsigned long long)g_stats.rx_msgs,
+        rx_us ? g_stats.rx_msgs * 1e6 / rx_us : 0.0);
+
+    for (i = 0; i < MSG_TYPE_MAX; i++)
+    {
+        if (g_stats.rx_by_type[i] == 0) continue;
+        LOG("received: type %d: %llu\n", i, (unsigned long long)g_stats.rx_by_type[i]);
+    }
+
+    if (g_stats.lat_num > 0)
+    {
+        LOG("send to next receive: %llu samples, min %llu us, avg %llu us, max %llu us\n",
+            (unsigned long long)g_stats.lat_num,
+            (unsigned long long)g_stats.lat_min_us,
+            (unsigned long long)(g_stats.lat_sum_us / g_stats.lat_num),
+            (unsigned long long)g_stats.lat_max_us);
+    }
+
+    if (g_opts.expected >= 0)
+    {
+        LOG("expected %d msgs, missing %lld (%.1f%% not received)\n",
+            g_opts.expected,
+            (long long)g_opts.expected - (long long)g_stats.rx_msgs,
+            g_opts.expected ? 100.0 * ((double)g_opts.expected - g_stats.rx_msgs) / g_opts.expected : 0.0);
+    }
+}
+
+static void print_usage(const char *prog)
+{
+    printf("Usage: %s [options]\n"
+           "  -p <path>    MeshSync socket path (default: OpenSync MESH_SOCKET_PATH_NAME)\n"
+           "  -f <file>    replay a script file\n"
+           "  -b <name>    run a built-in sequence: replay, channels, storm, kicks\n"
+           "  -n <count>   size of the built-in sequence (default %d)\n"
+           "  -i <ms>      delay between messages (default %d)\n"
+           "  -r <ms>      slow reader: sleep before each read from OpenSync (default %d)\n"
+           "  -l <ms>      keep reading after the sequence is sent (default %d)\n"
+           "  -e <count>   number of messages expected from OpenSync, to report missing ones\n"
+           "  -v           print every message\n",
+           prog, g_opts.count, g_opts.interval_ms, g_opts.read_delay_ms, g_opts.linger_ms);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    struct sockaddr_un addr;
+    int listen_fd;
+    bool ok;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:f:b:n:i:r:l:e:vh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'p': g_opts.sock_path = optarg; break;
+            case 'f': g_opts.script = optarg; break;
+            case 'b': g_opts.builtin = optarg; break;
+            case 'n': g_opts.count = atoi(optarg); break;
+            case 'i': g_opts.interval_ms = atoi(optarg); break;
+            case 'r': g_opts.read_delay_ms = atoi(optarg); break;
+            case 'l': g_opts.linger_ms = atoi(optarg); break;
+            case 'e': g_opts.expected = atoi(optarg); break;
+            case 'v': g_opts.verbose = true; break;
+            default: print_usage(argv[0]);
+        }
+    }
+    if (g_opts.script == NULL && g_opts.builtin == NULL) print_usage(argv[0]);
+
+    signal(SIGINT, sim_sig_handler);
+    signal(SIGTERM, sim_sig_handler);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+    {
+        ERR("socket creation failure, errno = %d\n", errno);
+        return 1;
+    }
+
+    sim_set_addr(&addr, g_opts.sock_path);
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(listen_fd, 1) < 0)
+    {
+        ERR("cannot listen on MeshSync socket, errno = %d\n", errno);
+        close(listen_fd);
+        return 1;
+    }
+
+    LOG("waiting for OpenSync to connect...\n");
+    g_client_fd = accept(listen_fd, NULL, NULL);
+    if (g_client_fd < 0)
+    {
+        ERR("accept failed, errno = %d\n", errno);
+        close(listen_fd);
+        return 1;
+    }
+    LOG("OpenSync connected\n");
+
+    // Let the sync client settle before the sequence starts
+    ok = sim_poll(100);
+
+    g_stats.seq_start_us = sim_time_us();
+    if (ok && g_opts.script != NULL) ok = sim_run_script(g_opts.script);
+    if (ok && g_opts.builtin != NULL) ok = sim_run_builtin(g_opts.builtin, g_opts.count);
+    g_stats.seq_end_us = sim_time_us();
+
+    if (ok) sim_poll(g_opts.linger_ms);
+
+    sim_report();
+
+    close(g_client_fd);
+    close(listen_fd);
+    if (*g_opts.sock_path != '\0') unlink(g_opts.sock_path);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,654 @@
+/*
+Copyright (c) 2021, Plume Design Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+   3. Neither the name of the Plume Design Inc. nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Plume Design Inc. BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Capacity sampler and survey ring tests against scripted HAL counters
+ *
+ * stats.c is compiled into this binary. The capacity sampler reads the
+ * channel and traffic counters through stats_capacity_hal_ops_t; the mock
+ * ops below replay a script of counter values, one entry per sample, so the
+ * tests can check deltas, resets, clamping and the ring without a radio.
+ * Survey samples are pushed to the survey ring directly.
+ *
+ * Usage: stats_test [test...]     (runs every test if none is given)
+ *
+ *   counters       deltas, counter resets, busy_tx clamping, HAL failures
+ *                  and the obsolete fields left zero
+ *   ring           ring wrap-around, running window sums and operating
+ *                  channel refresh
+ *   idle           sampler start on request and stop when nobody asks
+ *   survey         survey deltas and windows from the per-channel ring, in
+ *                  the configured counter mode, and the record fallback
+ *   pool           client and survey record reuse, free list limits and
+ *                  trimming
+ */
+
+#include "stats.c"
+
+#define TEST_SCRIPT_MAX         512
+#define TEST_RADIO_INDEX        1
+#define TEST_CHANNEL            36
+#define TEST_POOL_RECORDS       300
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: %s\n", __func__, __LINE__, #cond); \
+            g_failed++; \
+        } \
+    } while (0)
+
+static int g_failed;
+
+/*****************************************************************************/
+/* Mock HAL                                                                  */
+/*****************************************************************************/
+
+typedef struct
+{
+    uint64_t                    active;
+    uint64_t                    tx;
+    uint64_t                    bytes;
+    bool                        fail;
+} test_step_t;
+
+static struct
+{
+    test_step_t                 script[TEST_SCRIPT_MAX];
+    uint32_t                    num;
+    uint32_t                    step;
+    int                         channel_calls;
+    bool                        bad_request;
+} g_mock;
+
+static INT mock_channel_get(INT radioIndex, ULONG *channel)
+{
+    g_mock.channel_calls++;
+    if (radioIndex != TEST_RADIO_INDEX) g_mock.bad_request = true;
+
+    *channel = TEST_CHANNEL;
+    return RETURN_OK;
+}
+
+static INT mock_channel_stats_get(INT radioIndex, wifi_channelStats_t *stats, INT num)
+{
+    const test_step_t *step = &g_mock.script[g_mock.step];
+
+    if (radioIndex != TEST_RADIO_INDEX || num != 1 || stats->ch_number != TEST_CHANNEL)
+    {
+        g_mock.bad_request = true;
+    }
+
+    if (g_mock.step >= g_mock.num || step->fail) return RETURN_ERR;
+
+    stats->ch_utilization_total = step->active;
+    stats->ch_utilization_busy_tx = step->tx;
+    return RETURN_OK;
+}
+
+static INT mock_traffic_stats_get(INT radioIndex, wifi_radioTrafficStats2_t *stats)
+{
+    if (g_mock.step >= g_mock.num) return RETURN_ERR;
+
+    stats->radio_BytesSent = g_mock.script[g_mock.step].bytes;
+    return RETURN_OK;
+}
+
+static const stats_capacity_hal_ops_t g_mock_ops =
+{
+    .channel_get        = mock_channel_get,
+    .channel_stats_get  = mock_channel_stats_get,
+    .traffic_stats_get  = mock_traffic_stats_get,
+};
+
+// Rest of the target layer, not reached by the capacity sampler
+bool vap_controlled(const char *ifname) { return false; }
+char *target_map_ifname(char *ifname) { return ifname; }
+
+/*****************************************************************************/
+/* Helpers                                                                   */
+/*****************************************************************************/
+
+static void test_script(const test_step_t *steps, uint32_t num)
+{
+    memset(&g_mock, 0, sizeof(g_mock));
+    memcpy(g_mock.script, steps, num * sizeof(*steps));
+    g_mock.num = num;
+}
+
+static void test_sampler_reset(stats_capacity_sampler_t *sampler)
+{
+    memset(sampler, 0, sizeof(*sampler));
+    sampler->radio_index = TEST_RADIO_INDEX;
+}
+
+// Take one sample from the next script entry
+static void test_sample(stats_capacity_sampler_t *sampler)
+{
+    stats_capacity_sample(sampler);
+    g_mock.step++;
+}
+
+static uint64_t test_queue_total(const stats_capacity_data_t *data)
+{
+    uint64_t total = 0;
+    int i;
+
+    for (i = 0; i < RADIO_QUEUE_MAX_QTY; i++) total += data->queue[i];
+
+    return total;
+}
+
+/*****************************************************************************/
+/* Tests                                                                     */
+/*****************************************************************************/
+
+static void test_counters(void)
+{
+    /*
+     * With cumulative on-channel counters the first entry is the baseline,
+     * otherwise every entry already is a per-interval value. Bytes sent is
+     * always cumulative.
+     */
+    static const test_step_t steps[] =
+    {
+        { 1000,  100, 1000, false },
+        { 2000,  600, 3000, false },
+        { 3000, 2000, 6000, false },    // busy_tx beyond active time
+        {    0,    0,    0, true  },    // HAL failure, no sample
+        {  500,  100,  100, false },    // counters reset
+        { 1500, 1000, 1100, false },
+    };
+
+    const bool cumulative = CONFIG_RDK_CUMULATIVE_SURVEY_ONCHAN;
+    stats_capacity_sampler_t sampler;
+    stats_capacity_data_t *total = &sampler.total;
+    uint32_t i;
+
+    test_script(steps, ARRAY_SIZE(steps));
+    test_sampler_reset(&sampler);
+
+    for (i = 0; i < ARRAY_SIZE(steps); i++) test_sample(&sampler);
+
+    CHECK(!g_mock.bad_request);
+    CHECK(g_mock.channel_calls == 1);
+
+    if (cumulative)
+    {
+        // Deltas: (1000, 500), (1000, 1000 clamped), reset skipped, (1000, 900)
+        CHECK(sampler.samples == 3);
+        CHECK(total->chan_active == 3000);
+        CHECK(total->chan_tx == 2400);
+    }
+    else
+    {
+        CHECK(sampler.samples == 5);
+        CHECK(total->chan_active == 8000);
+        CHECK(total->chan_tx == 100 + 600 + 2000 + 100 + 1000);
+    }
+
+    // Bytes: 2000 + 3000, nothing across the reset, then 1000
+    CHECK(total->bytes_tx == 6000);
+    CHECK(total->chan_tx <= total->chan_active);
+    CHECK(sampler.count == sampler.samples);
+
+    // Obsolete fields are not filled
+    CHECK(total->samples == 0);
+    CHECK(test_queue_total(total) == 0);
+}
+
+static void test_ring(void)
+{
+    const bool cumulative = CONFIG_RDK_CUMULATIVE_SURVEY_ONCHAN;
+    stats_capacity_sampler_t sampler;
+    test_step_t steps[200];
+    uint64_t active = 0;
+    uint64_t tx = 0;
+    uint32_t i;
+
+    // 1000 active and 250 busy_tx per interval, 1500 bytes each
+    for (i = 0; i < ARRAY_SIZE(steps); i++)
+    {
+        steps[i].active = cumulative ? 1000 * (i + 1) : 1000;
+        steps[i].tx = cumulative ? 250 * (i + 1) : 250;
+        steps[i].bytes = 1500 * (i + 1);
+        steps[i].fail = false;
+    }
+
+    test_script(steps, ARRAY_SIZE(steps));
+    test_sampler_reset(&sampler);
+
+    for (i = 0; i < ARRAY_SIZE(steps); i++) test_sample(&sampler);
+
+    CHECK(sampler.samples == ARRAY_SIZE(steps) - (cumulative ? 1 : 0));
+    CHECK(sampler.count == STATS_CAPACITY_RING_DEPTH);
+    CHECK(sampler.head == (sampler.samples - 1) % STATS_CAPACITY_RING_DEPTH);
+
+    for (i = 0; i < sampler.count; i++)
+    {
+        active += sampler.ring_active[i];
+        tx += sampler.ring_tx[i];
+        CHECK(sampler.ring_bytes[i] == 1500);
+    }
+    CHECK(active == 1000 * STATS_CAPACITY_RING_DEPTH);
+    CHECK(tx == 250 * STATS_CAPACITY_RING_DEPTH);
+
+    // Running sums follow the ring across wrap-around
+    CHECK(sampler.win_active == active);
+    CHECK(sampler.win_tx == tx);
+    CHECK(sampler.win_bytes == 1500 * STATS_CAPACITY_RING_DEPTH);
+
+    // The operating channel is read on the first sample and every CHAN_ROUNDS
+    CHECK(g_mock.channel_calls == (int)((ARRAY_SIZE(steps) + STATS_CAPACITY_CHAN_ROUNDS - 1) /
+                                        STATS_CAPACITY_CHAN_ROUNDS));
+    CHECK(!g_mock.bad_request);
+}
+
+static void test_idle(void)
+{
+    stats_capacity_sampler_t *sampler = &g_capacity_sampler[TEST_RADIO_INDEX];
+    stats_capacity_data_t data;
+    radio_entry_t radio_cfg;
+    test_step_t steps[STATS_CAPACITY_IDLE_ROUNDS + 8];
+    uint64_t samples;
+    uint32_t i;
+
+    for (i = 0; i < ARRAY_SIZE(steps); i++)
+    {
+        steps[i].active = 1000 * (i + 1);
+        steps[i].tx = 100 * (i + 1);
+        steps[i].bytes = 100 * (i + 1);
+        steps[i].fail = false;
+    }
+    test_script(steps, ARRAY_SIZE(steps));
+
+    // Known radio, so the HAL is not asked for the radio index
+    memset(&radio_cfg, 0, sizeof(radio_cfg));
+    STRSCPY(radio_cfg.phy_name, "wifi1");
+    STRSCPY(g_radio_index_cache[0].phy_name, radio_cfg.phy_name);
+    g_radio_index_cache[0].radio_index = TEST_RADIO_INDEX;
+
+    CHECK(stats_capacity_get(&radio_cfg, &data));
+    CHECK(sampler->running);
+    CHECK(sampler->prev_valid);
+    g_mock.step++;
+
+    // Samples keep coming while requests do
+    for (i = 0; i < STATS_CAPACITY_IDLE_ROUNDS; i++)
+    {
+        stats_capacity_timer_cb(EV_DEFAULT, &sampler->timer, EV_TIMER);
+        g_mock.step++;
+    }
+    CHECK(sampler->running);
+
+    samples = sampler->samples;
+    CHECK(stats_capacity_get(&radio_cfg, &data));
+    CHECK(sampler->samples == samples);
+    CHECK(data.chan_active == sampler->total.chan_active);
+    CHECK(sampler->idle_rounds == 0);
+
+    // Nobody asks any more: the sampler stops and drops its baseline
+    for (i = 0; i <= STATS_CAPACITY_IDLE_ROUNDS && sampler->running; i++)
+    {
+        stats_capacity_timer_cb(EV_DEFAULT, &sampler->timer, EV_TIMER);
+    }
+    CHECK(!sampler->running);
+    CHECK(!sampler->prev_valid);
+    CHECK(!ev_is_active(&sampler->timer));
+    CHECK(!g_mock.bad_request);
+
+    // The cumulative record survives a restart
+    CHECK(stats_capacity_get(&radio_cfg, &data));
+    CHECK(sampler->running);
+    CHECK(sampler->samples >= samples);
+    CHECK(data.chan_active > 0);
+
+    ev_timer_stop(EV_DEFAULT, &sampler->timer);
+    sampler->running = false;
+}
+
+/*
+ * Interval values of survey sample i: 100 ms active, everything else a
+ * varying share of it
+ */
+static void test_survey_interval(uint32_t i, uint64_t *col)
+{
+    col[STATS_SURVEY_COL_ACTIVE]   = 100000;
+    col[STATS_SURVEY_COL_BUSY]     = 40000 + 1000 * i;
+    col[STATS_SURVEY_COL_BUSY_EXT] = 2000;
+    col[STATS_SURVEY_COL_TX]       = 10000 + 500 * i;
+    col[STATS_SURVEY_COL_RX]       = 20000;
+    col[STATS_SURVEY_COL_SELF]     = 5000 + 100 * i;
+}
+
+/*
+ * Fetch sample i the way stats_survey_get() does: push it to the ring and
+ * keep the HAL values in the record
+ */
+static void test_survey_fetch(
+        radio_scan_type_t           scan_type,
+        uint32_t                    i,
+        stats_survey_record_t      *record)
+{
+    wifi_channelStats_t chan_stats;
+    uint64_t hal[STATS_SURVEY_COL_QTY];
+    uint64_t col[STATS_SURVEY_COL_QTY];
+    uint32_t j;
+    int c;
+
+    // Cumulative counters report the sum of all intervals so far
+    memset(hal, 0, sizeof(hal));
+    for (j = stats_survey_cumulative(scan_type) ? 0 : i; j <= i; j++)
+    {
+        test_survey_interval(j, col);
+        for (c = 0; c < STATS_SURVEY_COL_QTY; c++) hal[c] += col[c];
+    }
+
+    memset(&chan_stats, 0, sizeof(chan_stats));
+    chan_stats.ch_number = TEST_CHANNEL;
+    chan_stats.ch_noise = -95;
+    chan_stats.ch_utilization_total = hal[STATS_SURVEY_COL_ACTIVE];
+    chan_stats.ch_utilization_busy = hal[STATS_SURVEY_COL_BUSY];
+    chan_stats.ch_utilization_busy_ext = hal[STATS_SURVEY_COL_BUSY_EXT];
+    chan_stats.ch_utilization_busy_tx = hal[STATS_SURVEY_COL_TX];
+    chan_stats.ch_utilization_busy_rx = hal[STATS_SURVEY_COL_RX];
+    chan_stats.ch_utilization_busy_self = hal[STATS_SURVEY_COL_SELF];
+
+    memset(record, 0, sizeof(*record));
+    record->info.chan = TEST_CHANNEL;
+    record->info.timestamp_ms = 1000 * (i + 1);
+    record->radio_index = TEST_RADIO_INDEX;
+    record->hist_seq = stats_survey_hist_push(TEST_RADIO_INDEX, scan_type,
+                                              record->info.timestamp_ms, &chan_stats);
+
+    if (scan_type == RADIO_SCAN_TYPE_ONCHAN)
+    {
+        record->stats.survey_bss.chan_active = hal[STATS_SURVEY_COL_ACTIVE];
+        record->stats.survey_bss.chan_busy = hal[STATS_SURVEY_COL_BUSY];
+        record->stats.survey_bss.chan_busy_ext = hal[STATS_SURVEY_COL_BUSY_EXT];
+        record->stats.survey_bss.chan_tx = hal[STATS_SURVEY_COL_TX];
+        record->stats.survey_bss.chan_rx = hal[STATS_SURVEY_COL_RX];
+        record->stats.survey_bss.chan_self = hal[STATS_SURVEY_COL_SELF];
+        record->stats.survey_bss.chan_noise = chan_stats.ch_noise;
+    }
+    else
+    {
+        record->stats.survey_obss.chan_active = hal[STATS_SURVEY_COL_ACTIVE];
+        record->stats.survey_obss.chan_busy = hal[STATS_SURVEY_COL_BUSY];
+        record->stats.survey_obss.chan_busy_ext = hal[STATS_SURVEY_COL_BUSY_EXT];
+        record->stats.survey_obss.chan_tx = hal[STATS_SURVEY_COL_TX];
+        record->stats.survey_obss.chan_rx = hal[STATS_SURVEY_COL_RX];
+        record->stats.survey_obss.chan_self = hal[STATS_SURVEY_COL_SELF];
+        record->stats.survey_obss.chan_noise = chan_stats.ch_noise;
+    }
+}
+
+// Expected report for the window of intervals (first, last]
+static void test_survey_expect(
+        radio_scan_type_t           scan_type,
+        uint32_t                    first,
+        uint32_t                    last,
+        dpp_survey_record_t        *expect)
+{
+    uint64_t total[STATS_SURVEY_COL_QTY];
+    uint64_t col[STATS_SURVEY_COL_QTY];
+    uint32_t i;
+    int c;
+
+    memset(total, 0, sizeof(total));
+    for (i = first + 1; i <= last; i++)
+    {
+        test_survey_interval(i, col);
+        for (c = 0; c < STATS_SURVEY_COL_QTY; c++) total[c] += col[c];
+    }
+
+    memset(expect, 0, sizeof(*expect));
+    expect->chan_busy = PERCENT(total[STATS_SURVEY_COL_BUSY], total[STATS_SURVEY_COL_ACTIVE]);
+    expect->chan_tx = PERCENT(total[STATS_SURVEY_COL_TX], total[STATS_SURVEY_COL_ACTIVE]);
+    expect->chan_rx = PERCENT(total[STATS_SURVEY_COL_RX], total[STATS_SURVEY_COL_ACTIVE]);
+    expect->duration_ms = total[STATS_SURVEY_COL_ACTIVE] / 1000;
+    expect->chan_noise = -95;
+    if (scan_type == RADIO_SCAN_TYPE_ONCHAN)
+    {
+        expect->chan_self = PERCENT(total[STATS_SURVEY_COL_SELF], total[STATS_SURVEY_COL_ACTIVE]);
+        expect->chan_busy_ext = PERCENT(total[STATS_SURVEY_COL_BUSY_EXT],
+                                        total[STATS_SURVEY_COL_ACTIVE]);
+    }
+}
+
+static bool test_survey_same(const dpp_survey_record_t *a, const dpp_survey_record_t *b)
+{
+    return a->chan_busy == b->chan_busy &&
+           a->chan_tx == b->chan_tx &&
+           a->chan_rx == b->chan_rx &&
+           a->chan_self == b->chan_self &&
+           a->chan_busy_ext == b->chan_busy_ext &&
+           a->duration_ms == b->duration_ms &&
+           a->chan_noise == b->chan_noise;
+}
+
+static void test_survey_scan(radio_scan_type_t scan_type)
+{
+    const uint32_t num = STATS_SURVEY_HIST_DEPTH + 4;
+    const bool cumulative = stats_survey_cumulative(scan_type);
+    stats_survey_record_t records[STATS_SURVEY_HIST_DEPTH + 4];
+    stats_survey_record_t old;
+    dpp_survey_record_t result;
+    dpp_survey_record_t expect;
+    radio_entry_t radio_cfg;
+    uint32_t last = num - 1;
+    uint32_t i;
+
+    memset(&radio_cfg, 0, sizeof(radio_cfg));
+    stats_survey_ring_cleanup();
+
+    for (i = 0; i < num; i++)
+    {
+        test_survey_fetch(scan_type, i, &records[i]);
+        CHECK(records[i].hist_seq == i + 1);
+    }
+
+    // Consecutive samples
+    for (i = num - STATS_SURVEY_HIST_DEPTH + 1; i < num; i++)
+    {
+        memset(&result, 0, sizeof(result));
+        CHECK(stats_survey_convert(&radio_cfg, scan_type, &records[i], &records[i - 1], &result));
+        test_survey_expect(scan_type, i - 1, i, &expect);
+        CHECK(test_survey_same(&result, &expect));
+    }
+
+    /*
+     * The oldest sample still in the ring: the report covers every interval
+     * since, in both counter modes. The record values are not used, so
+     * clobbering them must not matter.
+     */
+    old = records[num - STATS_SURVEY_HIST_DEPTH];
+    memset(&old.stats, 0, sizeof(old.stats));
+    memset(&result, 0, sizeof(result));
+    CHECK(stats_survey_convert(&radio_cfg, scan_type, &records[last], &old, &result));
+    test_survey_expect(scan_type, num - STATS_SURVEY_HIST_DEPTH, last, &expect);
+    CHECK(test_survey_same(&result, &expect));
+
+    /*
+     * A sample which left the ring: back to the record values, which with
+     * one-shot counters only describe the newest interval
+     */
+    memset(&result, 0, sizeof(result));
+    CHECK(stats_survey_convert(&radio_cfg, scan_type, &records[last], &records[0], &result));
+    test_survey_expect(scan_type, cumulative ? 0 : last - 1, last, &expect);
+    CHECK(test_survey_same(&result, &expect));
+
+    // Same for records of another radio and records without a ring sample
+    old = records[last - 1];
+    old.radio_index = TEST_RADIO_INDEX + 1;
+    memset(&result, 0, sizeof(result));
+    CHECK(stats_survey_convert(&radio_cfg, scan_type, &records[last], &old, &result));
+    test_survey_expect(scan_type, last - 1, last, &expect);
+    CHECK(test_survey_same(&result, &expect));
+
+    old = records[last - 1];
+    old.hist_seq = 0;
+    memset(&result, 0, sizeof(result));
+    CHECK(stats_survey_convert(&radio_cfg, scan_type, &records[last], &old, &result));
+    CHECK(test_survey_same(&result, &expect));
+
+    // Cleanup releases the channel slots, conversion keeps working
+    stats_survey_ring_cleanup();
+    CHECK(stats_survey_hist_get(TEST_RADIO_INDEX, scan_type, TEST_CHANNEL, false) == NULL);
+    memset(&result, 0, sizeof(result));
+    CHECK(stats_survey_convert(&radio_cfg, scan_type, &records[last], &records[last - 1], &result));
+    CHECK(test_survey_same(&result, &expect));
+}
+
+static void test_survey(void)
+{
+    test_survey_scan(RADIO_SCAN_TYPE_ONCHAN);
+    test_survey_scan(RADIO_SCAN_TYPE_OFFCHAN);
+}
+
+/*
+ * Record pools: released records are handed out again, the free lists are
+ * bounded and trimmed back to what the last STATS_POOL_TRIM_ROUNDS needed.
+ */
+static void test_pool_reset(stats_pool_t *pool)
+{
+    stats_pool_flush(pool);
+    pool->allocs = 0;
+    pool->reuses = 0;
+    pool->releases = 0;
+    pool->in_use = 0;
+    pool->in_use_peak = 0;
+    pool->trim_rounds = 0;
+}
+
+// Take num records from the pool and give them all back
+static void test_pool_cycle(stats_pool_t *pool, uint32_t num)
+{
+    static void *records[TEST_POOL_RECORDS];
+    uint32_t i;
+
+    for (i = 0; i < num; i++) records[i] = stats_pool_get(pool);
+    for (i = 0; i < num; i++) stats_pool_put(pool, records[i]);
+}
+
+static void test_pool(void)
+{
+    stats_client_record_t *client;
+    uint32_t round;
+
+    test_pool_reset(&g_client_pool);
+    test_pool_reset(&g_survey_pool);
+
+    // Free lists are bounded
+    test_pool_cycle(&g_client_pool, TEST_POOL_RECORDS);
+    CHECK(g_client_pool.allocs == TEST_POOL_RECORDS);
+    CHECK(g_client_pool.releases == TEST_POOL_RECORDS);
+    CHECK(g_client_pool.in_use == 0);
+    CHECK(g_client_pool.free_num == 256);
+
+    test_pool_cycle(&g_survey_pool, TEST_POOL_RECORDS);
+    CHECK(g_survey_pool.allocs == TEST_POOL_RECORDS);
+    CHECK(g_survey_pool.free_num == 128);
+
+    // Released records are reused and handed out zeroed
+    client = stats_client_record_alloc();
+    client->stats_cookie = 1;
+    stats_client_record_free(client);
+    client = stats_client_record_alloc();
+    CHECK(client->stats_cookie == 0);
+    stats_client_record_free(client);
+    test_pool_cycle(&g_client_pool, 100);
+    CHECK(g_client_pool.allocs == TEST_POOL_RECORDS);
+    CHECK(g_client_pool.reuses == 102);
+    CHECK(g_client_pool.free_num == 256);
+
+    // Nothing is trimmed before STATS_POOL_TRIM_ROUNDS, the first trim keeps
+    // what the burst needed
+    for (round = 1; round < 16; round++)
+    {
+        stats_pool_trim(&g_client_pool);
+        CHECK(g_client_pool.free_num == 256);
+    }
+    stats_pool_trim(&g_client_pool);
+    CHECK(g_client_pool.free_num == 256);
+
+    // Steady state of 20 records per round: trimmed down on the next trim
+    for (round = 1; round < 16; round++)
+    {
+        stats_pool_trim(&g_client_pool);
+        CHECK(g_client_pool.free_num == 256);
+        test_pool_cycle(&g_client_pool, 20);
+    }
+    stats_pool_trim(&g_client_pool);
+    CHECK(g_client_pool.free_num == 20);
+    CHECK(g_client_pool.in_use_peak == 0);
+
+    test_pool_reset(&g_client_pool);
+    test_pool_reset(&g_survey_pool);
+}
+
+/*****************************************************************************/
+
+static const struct
+{
+    const char                 *name;
+    void                      (*fn)(void);
+} g_tests[] =
+{
+    { "counters",       test_counters },
+    { "ring",           test_ring },
+    { "idle",           test_idle },
+    { "survey",         test_survey },
+    { "pool",           test_pool },
+};
+
+int main(int argc, char **argv)
+{
+    bool run;
+    size_t t;
+    int a;
+
+    log_open("STATS_TEST", LOG_OPEN_STDOUT);
+    log_severity_set(LOG_SEVERITY_WARN);
+
+    stats_capacity_hal_ops_set(&g_mock_ops);
+
+    for (t = 0; t < ARRAY_SIZE(g_tests); t++)
+    {
+        run = (argc < 2);
+        for (a = 1; a < argc; a++)
+        {
+            if (!strcmp(argv[a], g_tests[t].name)) run = true;
+        }
+        if (!run) continue;
+
+        printf("%s\n", g_tests[t].name);
+        g_tests[t].fn();
+    }
+
+    printf("%s\n", g_failed ? "FAILED" : "PASSED");
+    return g_failed ? 1 : 0;
+}
@@ -0,0 +1,507 @@
+/*
+Copyright (c) 2021, Plume Design Inc. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+   1. Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+   3. Neither the name of the Plume Design Inc. nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Plume Design Inc. BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * MeshSync client tests over a socketpair
+ *
+ * sync.c is compiled into this binary. Each test hands one end of a
+ * socketpair to the sync client as if it had just connected and plays the
+ * mesh agent on the other end. The HAL and the rest of the target layer are
+ * mocked below; received SSID updates are recorded so the tests can check
+ * what the client parsed.
+ *
+ * Usage: sync_test [test...]     (runs every test if none is given)
+ *
+ *   rx             fragmented and concatenated frames, split headers
+ *   tx             outbound queue against a slow reader: coalescing, order,
+ *                  final state and drop accounting
+ */
+
+#include "sync.c"
+
+#include <sys/socket.h>
+
+#define TEST_RX_FRAMES          200
+#define TEST_RX_MAX             (2 * TEST_RX_FRAMES)
+#define TEST_TX_ROUNDS          50
+#define TEST_TX_BURST           20
+#define TEST_TX_VAPS            8
+#define TEST_TX_RADIOS          3
+#define TEST_TX_SOCKBUF         4096
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: %s\n", __func__, __LINE__, #cond); \
+            g_failed++; \
+        } \
+    } while (0)
+
+static int g_failed;
+
+/*****************************************************************************/
+/* Mocks                                                                     */
+/*****************************************************************************/
+
+struct ev_loop *wifihal_evloop;
+
+static struct
+{
+    uint32_t                    ssid_num;
+    int                         ssid_index[TEST_RX_MAX];
+    char                        ssid[TEST_RX_MAX][32];
+} g_mock;
+
+INT wifi_getApName(INT apIndex, CHAR *output_string)
+{
+    sprintf(output_string, "test%d", apIndex);
+    return RETURN_OK;
+}
+
+INT wifi_getRadioIfName(INT radioIndex, CHAR *output_string)
+{
+    sprintf(output_string, "radio%d", radioIndex);
+    return RETURN_OK;
+}
+
+INT wifi_getRadioVapInfoMap(wifi_radio_index_t index, wifi_vap_info_map_t *map)
+{
+    memset(map, 0, sizeof(*map));
+    return RETURN_OK;
+}
+
+bool vif_external_ssid_update(const char *ssid, int ssid_index)
+{
+    if (g_mock.ssid_num < TEST_RX_MAX)
+    {
+        g_mock.ssid_index[g_mock.ssid_num] = ssid_index;
+        STRSCPY(g_mock.ssid[g_mock.ssid_num], ssid);
+    }
+    g_mock.ssid_num++;
+
+    return true;
+}
+
+// Keep resync out of the tests, sync_resync_vap() skips uncontrolled VAPs
+bool vap_controlled(const char *ifname) { return false; }
+
+bool vif_external_security_update(int ssid_index) { return true; }
+bool vif_external_acl_update(INT ssid_index) { return true; }
+bool vif_state_update(INT ssidIndex) { return true; }
+bool is_home_ap(const char *ifname) { return false; }
+bool clients_hal_fetch_existing(unsigned int apIndex) { return true; }
+bool radio_state_update(UINT radioIndex) { return true; }
+void radio_trigger_resync(void) { }
+bool radio_cloud_mode_set(radio_cloud_mode_t mode) { return true; }
+radio_cloud_mode_t radio_cloud_mode_get(void) { return RADIO_CLOUD_MODE_FULL; }
+void cloud_config_set_mode(const char *device_mode) { }
+bool target_managers_restart(void) { return true; }
+
+bool ssid_index_to_vap_info(UINT ssid_index, wifi_vap_info_map_t *map, wifi_vap_info_t **vap_info)
+{
+    return false;
+}
+
+/*****************************************************************************/
+/* Helpers                                                                   */
+/*****************************************************************************/
+
+/*
+ * Hand fd to the sync client the way sync_connect() does once connected.
+ * Returns the agent end of the socketpair.
+ */
+static int test_attach(void)
+{
+    int sv[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0)
+    {
+        printf("  socketpair() failed, errno = %d\n", errno);
+        exit(2);
+    }
+
+    memset(&sync_rx, 0, sizeof(sync_rx));
+    memset(&sync_tx, 0, sizeof(sync_tx));
+    memset(&g_mock, 0, sizeof(g_mock));
+
+    ev_io_init(&sync_evio, sync_evio_cb, sv[0], EV_READ);
+    ev_io_start(wifihal_evloop, &sync_evio);
+    ev_io_init(&sync_tx.evio, sync_tx_evio_cb, sv[0], EV_WRITE);
+
+    sync_fd = sv[0];
+    sync_mgr = SYNC_MGR_WM;
+    sync_initialized = true;
+
+    return sv[1];
+}
+
+static void test_detach(int agent_fd)
+{
+    sync_disconnect();
+    sync_initialized = false;
+    close(agent_fd);
+}
+
+// Let the sync client handle whatever is pending on its socket
+static void test_pump(void)
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+        ev_run(wifihal_evloop, EVRUN_NOWAIT);
+    }
+}
+
+static void test_ssid_msg(MeshSync *mp, int n)
+{
+    memset(mp, 0, sizeof(*mp));
+    mp->msgType = MESH_WIFI_SSID_NAME;
+    mp->data.wifiSSIDName.index = n % 8;
+    snprintf(mp->data.wifiSSIDName.ssid, sizeof(mp->data.wifiSSIDName.ssid), "ssid-%d", n);
+}
+
+static void test_write(int fd, const void *data, size_t len)
+{
+    if (write(fd, data, len) != (ssize_t)len)
+    {
+        printf("  write() failed, errno = %d\n", errno);
+        exit(2);
+    }
+}
+
+// Were the first n frames received intact and in order?
+static bool test_rx_check(int n)
+{
+    char ssid[32];
+    int i;
+
+    if (g_mock.ssid_num != (uint32_t)n) return false;
+
+    for (i = 0; i < n; i++)
+    {
+        snprintf(ssid, sizeof(ssid), "ssid-%d", i);
+        if (g_mock.ssid_index[i] != i % 8 || strcmp(g_mock.ssid[i], ssid)) return false;
+    }
+
+    return true;
+}
+
+/*
+ * Slow mesh agent: reads at most max_frames frames, keeping what it saw.
+ * SSID and channel updates carry increasing sequence numbers, so every key
+ * must only ever move forward.
+ */
+static struct
+{
+    uint8_t                     buf[sizeof(MeshSync)];
+    size_t                      len;
+    uint32_t                    frames;
+    int                         ssid_seq[TEST_TX_VAPS];
+    int                         channel_seq[TEST_TX_RADIOS];
+    int                         connect_seq;    // last in-order client connect
+    bool                        regressed;
+    bool                        reordered;
+} g_agent;
+
+static void test_agent_frame(const MeshSync *mp)
+{
+    int seq;
+
+    g_agent.frames++;
+
+    switch (mp->msgType)
+    {
+        case MESH_WIFI_SSID_NAME:
+            seq = atoi(mp->data.wifiSSIDName.ssid + strlen("ssid-"));
+            if (seq <= g_agent.ssid_seq[mp->data.wifiSSIDName.index]) g_agent.regressed = true;
+            g_agent.ssid_seq[mp->data.wifiSSIDName.index] = seq;
+            break;
+
+        case MESH_WIFI_RADIO_CHANNEL:
+            seq = mp->data.wifiRadioChannel.channel;
+            if (seq <= g_agent.channel_seq[mp->data.wifiRadioChannel.index]) g_agent.regressed = true;
+            g_agent.channel_seq[mp->data.wifiRadioChannel.index] = seq;
+            break;
+
+        case MESH_CLIENT_CONNECT:
+            seq = atoi(mp->data.meshConnect.host + strlen("host-"));
+            if (seq != g_agent.connect_seq + 1) g_agent.reordered = true;
+            g_agent.connect_seq = seq;
+            break;
+
+        default:
+            break;
+    }
+}
+
+static uint32_t test_agent_read(int fd, uint32_t max_frames)
+{
+    uint32_t frames = 0;
+    ssize_t ret;
+
+    while (frames < max_frames)
+    {
+        ret = recv(fd, g_agent.buf + g_agent.len, sizeof(g_agent.buf) - g_agent.len, MSG_DONTWAIT);
+        if (ret <= 0) break;
+
+        g_agent.len += ret;
+        if (g_agent.len < sizeof(g_agent.buf)) continue;
+
+        test_agent_frame((const MeshSync *)g_agent.buf);
+        g_agent.len = 0;
+        frames++;
+    }
+
+    return frames;
+}
+
+/*****************************************************************************/
+/* Tests                                                                     */
+/*****************************************************************************/
+
+static void test_rx(void)
+{
+    static MeshSync msgs[TEST_RX_FRAMES];
+    const uint8_t *stream = (const uint8_t *)msgs;
+    const size_t total = sizeof(msgs);
+    size_t off;
+    size_t len;
+    int agent;
+    int fd;
+    int i;
+
+    for (i = 0; i < TEST_RX_FRAMES; i++) test_ssid_msg(&msgs[i], i);
+
+    // All frames back-to-back in one write: handled in a few wakeups
+    agent = test_attach();
+    fd = sync_fd;
+    test_write(agent, stream, total);
+    test_pump();
+    CHECK(sync_fd == fd);
+    CHECK(test_rx_check(TEST_RX_FRAMES));
+    CHECK(sync_rx.len == 0);
+    CHECK(sync_rx.wakeups < TEST_RX_FRAMES / SYNC_RX_BUF_MSGS);
+    test_detach(agent);
+
+    // Header split: the first bytes of msgType arrive alone
+    agent = test_attach();
+    fd = sync_fd;
+    test_write(agent, stream, 2);
+    test_pump();
+    CHECK(g_mock.ssid_num == 0);
+    CHECK(sync_rx.len == 2);
+    test_write(agent, stream + 2, sizeof(MeshSync) - 2);
+    test_pump();
+    CHECK(sync_fd == fd);
+    CHECK(test_rx_check(1));
+    test_detach(agent);
+
+    // A frame and a half, then the rest: one frame per wakeup boundary
+    agent = test_attach();
+    fd = sync_fd;
+    off = 0;
+    while (off < total)
+    {
+        len = sizeof(MeshSync) + sizeof(MeshSync) / 2;
+        if (len > total - off) len = total - off;
+        test_write(agent, stream + off, len);
+        off += len;
+        test_pump();
+    }
+    CHECK(sync_fd == fd);
+    CHECK(test_rx_check(TEST_RX_FRAMES));
+    CHECK(sync_rx.len == 0);
+    CHECK(sync_rx.split > 0);
+    test_detach(agent);
+
+    // Arbitrary chunk sizes, from single bytes up to several frames
+    agent = test_attach();
+    fd = sync_fd;
+    srandom(1);
+    off = 0;
+    while (off < total)
+    {
+        len = 1 + random() % (3 * sizeof(MeshSync));
+        if (len > total - off) len = total - off;
+        test_write(agent, stream + off, len);
+        off += len;
+        test_pump();
+    }
+    CHECK(sync_fd == fd);
+    CHECK(test_rx_check(TEST_RX_FRAMES));
+    CHECK(sync_rx.len == 0);
+
+    // A trailing partial frame is held back, not parsed
+    test_write(agent, stream, sizeof(MeshSync) / 2);
+    test_pump();
+    CHECK(sync_rx.len == sizeof(MeshSync) / 2);
+    CHECK(g_mock.ssid_num == TEST_RX_FRAMES);
+    test_detach(agent);
+
+    printf("  %d frames parsed in every split pattern\n", TEST_RX_FRAMES);
+}
+
+static void test_tx(void)
+{
+    int ssid_last[TEST_TX_VAPS];
+    int channel_last[TEST_TX_RADIOS];
+    uint32_t sent = 0;
+    uint32_t rejected;
+    MeshSync msg;
+    int bufsize = TEST_TX_SOCKBUF;
+    int seq = 0;
+    int round;
+    int agent;
+    int fd;
+    int i;
+
+    memset(&g_agent, 0, sizeof(g_agent));
+    memset(ssid_last, 0, sizeof(ssid_last));
+    memset(channel_last, 0, sizeof(channel_last));
+
+    agent = test_attach();
+    fd = sync_fd;
+    setsockopt(sync_fd, SOL_SOCKET, SO_SNDBUF, &bufsize, sizeof(bufsize));
+    setsockopt(agent, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+
+    // Bursts of state updates and client events, the agent reads two frames per round
+    for (round = 0; round < TEST_TX_ROUNDS; round++)
+    {
+        for (i = 0; i < TEST_TX_BURST; i++)
+        {
+            seq++;
+
+            test_ssid_msg(&msg, seq);
+            msg.data.wifiSSIDName.index = seq % TEST_TX_VAPS;
+            ssid_last[seq % TEST_TX_VAPS] = seq;
+            CHECK(sync_send_msg(&msg));
+
+            memset(&msg, 0, sizeof(msg));
+            msg.msgType = MESH_WIFI_RADIO_CHANNEL;
+            msg.data.wifiRadioChannel.index = seq % TEST_TX_RADIOS;
+            msg.data.wifiRadioChannel.channel = seq;
+            channel_last[seq % TEST_TX_RADIOS] = seq;
+            CHECK(sync_send_msg(&msg));
+
+            sent += 2;
+        }
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msgType = MESH_CLIENT_CONNECT;
+        msg.data.meshConnect.iface = MESH_IFACE_WIFI;
+        msg.data.meshConnect.isConnected = true;
+        snprintf(msg.data.meshConnect.host, sizeof(msg.data.meshConnect.host), "host-%d", round + 1);
+        CHECK(sync_send_msg(&msg));
+        sent++;
+
+        test_agent_read(agent, 2);
+        test_pump();
+    }
+
+    CHECK(sync_tx.count > 0);
+
+    // Agent catches up
+    for (i = 0; i < 1000 && sync_tx.count > 0; i++)
+    {
+        test_agent_read(agent, UINT32_MAX);
+        test_pump();
+    }
+    while (test_agent_read(agent, UINT32_MAX) > 0);
+
+    CHECK(sync_fd == fd);
+    CHECK(sync_tx.count == 0);
+    CHECK(sync_tx.dropped == 0);
+    CHECK(sync_tx.coalesced > 0);
+    CHECK(sync_tx.queued + sync_tx.coalesced == sent);
+    CHECK(g_agent.frames == sync_tx.queued);
+    CHECK(g_agent.len == 0);
+    CHECK(!g_agent.regressed);
+    CHECK(!g_agent.reordered);
+    CHECK(g_agent.connect_seq == TEST_TX_ROUNDS);
+    for (i = 0; i < TEST_TX_VAPS; i++) CHECK(g_agent.ssid_seq[i] == ssid_last[i]);
+    for (i = 0; i < TEST_TX_RADIOS; i++) CHECK(g_agent.channel_seq[i] == channel_last[i]);
+
+    printf("  %u messages sent: %llu delivered, %llu coalesced, %llu dropped\n",
+           sent,
+           (unsigned long long)sync_tx.queued,
+           (unsigned long long)sync_tx.coalesced,
+           (unsigned long long)sync_tx.dropped);
+
+    // Agent stops reading: the queue is bounded and every drop is reported
+    rejected = 0;
+    for (i = 0; i < 2 * SYNC_TX_QUEUE_MAX + 64; i++)
+    {
+        memset(&msg, 0, sizeof(msg));
+        msg.msgType = MESH_CLIENT_CONNECT;
+        if (!sync_send_msg(&msg)) rejected++;
+    }
+    CHECK(rejected > 0);
+    CHECK(sync_tx.dropped == rejected);
+    CHECK(sync_tx.count == SYNC_TX_QUEUE_MAX);
+
+    test_detach(agent);
+}
+
+/*****************************************************************************/
+
+static const struct
+{
+    const char                 *name;
+    void                      (*fn)(void);
+} g_tests[] =
+{
+    { "rx",             test_rx },
+    { "tx",             test_tx },
+};
+
+int main(int argc, char **argv)
+{
+    bool run;
+    size_t t;
+    int a;
+
+    log_open("SYNC_TEST", LOG_OPEN_STDOUT);
+    log_severity_set(LOG_SEVERITY_WARN);
+
+    wifihal_evloop = EV_DEFAULT;
+
+    for (t = 0; t < ARRAY_SIZE(g_tests); t++)
+    {
+        run = (argc < 2);
+        for (a = 1; a < argc; a++)
+        {
+            if (!strcmp(argv[a], g_tests[t].name)) run = true;
+        }
+        if (!run) continue;
+
+        printf("%s\n", g_tests[t].name);
+        g_tests[t].fn();
+    }
+
+    printf("%s\n", g_failed ? "FAILED" : "PASSED");
+    return g_failed ? 1 : 0;
+}